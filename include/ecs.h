@@ -18,6 +18,15 @@
 #ifndef ECS_ECS_HASH_H_
 #define ECS_ECS_HASH_H_
 
+// begin --- signature.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SIGNATURE_H
+#define ECS_SIGNATURE_H
+
 // begin --- types.h --- 
 
 //
@@ -27,8 +36,8 @@
 #ifndef ECS_ECS_TYPES_H_
 #define ECS_ECS_TYPES_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <typeindex>
 
 namespace ecs {
 
@@ -37,7 +46,12 @@ struct Entity;
 struct ECSBase;
 struct ECS;
 
+struct ComponentBase;
 struct ComponentEntityList;
+struct ComponentPoolBase;
+
+template<typename T>
+struct ComponentPool;
 
 struct System;
 
@@ -47,11 +61,40 @@ struct EntityIterator;
 template<typename... RTypes>
 struct EntitySubSet;
 
-typedef std::size_t     ID;
-typedef std::type_index Hash;
+template<typename... Types>
+struct View;
+
+struct QueryBase;
+template<typename... Types>
+struct Query;
+
+struct GroupBase;
+template<typename... Types>
+struct Group;
+
+typedef std::size_t ID;
+typedef std::size_t Hash;
+// counts the stages run by the ecs, used to tell which components changed since a system last ran
+typedef std::uint64_t Tick;
 
 #define INVALID_ID   ID(-1)
-#define INVALID_HASH Hash(typeid(void))
+#define INVALID_HASH Hash(-1)
+
+// how pools are sorted. insertion sort is linear for data which is already nearly sorted, e.g.
+// when sorting by a key which changes little from frame to frame
+enum SortMode : unsigned {
+    SORT_FULL,
+    SORT_INSERTION
+};
+
+// the lifecycle hooks of a component which are dispatched by the ecs
+enum ComponentHook : unsigned {
+    HOOK_COMPONENT_REMOVED,
+    HOOK_ENTITY_ACTIVATED,
+    HOOK_ENTITY_DEACTIVATED,
+    HOOK_OTHER_COMPONENT_ADDED,
+    HOOK_COUNT
+};
 
 
 }    // namespace ecs_
@@ -63,21 +106,96 @@ typedef std::type_index Hash;
 
 
 
+#include <bitset>
+
+// maximum amount of distinct component types. can be raised at compile time if required
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+
+namespace ecs {
+
+// set of component types, one bit per component hash
+typedef std::bitset<ECS_MAX_COMPONENTS> Signature;
+
+/**
+ * @brief Builds the signature containing the given component types.
+ *
+ * Queries compute this once so matching an entity against all requested
+ * component types becomes a single AND and compare.
+ *
+ * @tparam Types The component types to set within the signature.
+ * @return Signature The signature with the bits of all given types set.
+ */
+template<typename... Types>
+Signature signature_of() {
+    Signature signature {};
+    (signature.set(Types::hash()), ...);
+    return signature;
+}
+
+}    // namespace ecs
+
+#endif    // ECS_SIGNATURE_H
+
+
+// end --- signature.h --- 
+
+
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
 namespace ecs {
 
+/**
+ * @brief Hands out consecutive hashes for the types of a family.
+ *
+ * Each family (e.g. components or events) counts separately so the hashes of a family stay small
+ * and dense and can be used to index plain arrays.
+ *
+ * @tparam Family The family the hashes are generated for.
+ */
+template<typename Family>
+struct TypeCounter {
+    static Hash next() {
+        static std::atomic<Hash> counter {0};
+        return counter++;
+    }
+};
+
+// component hashes index the signature of an entity, so the limit is checked as soon as a
+// component type asks for its hash, before any signature is touched
+template<>
+struct TypeCounter<ComponentBase> {
+    static Hash next() {
+        static std::atomic<Hash> counter {0};
+        Hash                     hash = counter++;
+        if (hash >= ECS_MAX_COMPONENTS) {
+            throw std::length_error("ecs: more than " + std::to_string(ECS_MAX_COMPONENTS)
+                                    + " component types, define a larger ECS_MAX_COMPONENTS");
+        }
+        return hash;
+    }
+};
+
 /**
  * @brief Generates a hash for the specified type.
  *
- * This function template generates a hash value for a given type using
- * the C++ type_index and typeid mechanisms. This is useful for type identification
- * and comparison within the ECS (Entity Component System) framework.
+ * This function template assigns each type a small integer the first time it is
+ * requested for a given family. The hash is cached in a static so later calls are
+ * a plain load. This is used for type identification and to index the pools and
+ * listener lists within the ECS (Entity Component System) framework.
  *
  * @tparam T The type for which the hash is to be generated.
+ * @tparam Family The family whose counter is used, defaults to a shared family.
  * @return Hash The generated hash value representing the type.
  */
-template<typename T>
+template<typename T, typename Family = void>
 Hash get_type_hash() {
-    return std::type_index(typeid(T));
+    static const Hash hash = TypeCounter<Family>::next();
+    return hash;
 }
 
 }    // namespace ecs_
@@ -100,8 +218,11 @@ Hash get_type_hash() {
 
 namespace ecs {
 
+// the id of an entity is the slot it occupies within the ecs. slots are reused once an entity is
+// destroyed, so each id also carries the generation of its slot to detect stale handles.
 struct EntityID {
-    ID id = INVALID_ID;
+    ID id         = INVALID_ID;
+    ID generation = 0;
     operator ID() const { return id; }
     operator ID&() { return id; }
 };
@@ -111,8 +232,6 @@ struct ComponentID {
     Hash hash = INVALID_HASH;
     operator ID() const { return id; }
     operator ID&() { return id; }
-    operator Hash() const { return hash; }
-    operator Hash&() { return hash; }
 };
 
 struct SystemID {
@@ -126,8 +245,6 @@ struct EventListenerID {
     Hash hash = INVALID_HASH;
     operator ID() const { return id; }
     operator ID&() { return id; }
-    operator Hash() const { return hash; }
-    operator Hash&() { return hash; }
 };
 
 } // namespace ecs
@@ -140,7 +257,6 @@ struct EventListenerID {
 
 
 #include <memory>
-
 namespace ecs {
 
 struct EventListenerBase {
@@ -149,7 +265,7 @@ struct EventListenerBase {
 
 template<typename Event>
 struct EventListener : public EventListenerBase {
-    const Hash hash = get_type_hash<Event>();
+    const Hash hash = get_type_hash<Event, EventListenerBase>();
 
     virtual void receive(ECS* ecs, const Event& event) = 0;
 };
@@ -171,6 +287,7 @@ struct EventListener : public EventListenerBase {
 #ifndef ECS_ENTITY_SUBSET_H
 #define ECS_ENTITY_SUBSET_H
 
+
 // begin --- entity_iterator.h --- 
 
 #ifndef ECS_ECS_ITERATOR_H_
@@ -199,241 +316,936 @@ struct EventListener : public EventListenerBase {
 #ifndef F3D_ECS_BASE_H
 #define F3D_ECS_BASE_H
 
-namespace ecs{
-
-struct ECSBase {
-    virtual void component_removed(Hash, EntityID) = 0;
-    virtual void component_added(Hash, EntityID) = 0;
-
-    virtual void entity_activated(EntityID) = 0;
-    virtual void entity_deactivated(EntityID) = 0;
-
-    virtual void destroy_entity(EntityID) = 0;
-    virtual void destroy_system(SystemID) = 0;
-    virtual void destroy_listener(EventListenerID) = 0;
-};
+// begin --- component_pool.h --- 
 
-}
+//
+// Created by Finn Eggers on 16.10.26.
+//
 
-#endif    // F3D_ECS_BASE_H
+#ifndef ECS_COMPONENT_POOL_H
+#define ECS_COMPONENT_POOL_H
 
+// begin --- aligned_allocator.h --- 
 
-// end --- ecs_base.h --- 
+//
+// Created by Finn Eggers on 16.10.26.
+//
 
+#ifndef ECS_ALIGNED_ALLOCATOR_H
+#define ECS_ALIGNED_ALLOCATOR_H
 
+#include <cstddef>
+#include <new>
+#include <vector>
 
-#include <ostream>
-#include <type_traits>
-#include <memory>
+// alignment of component columns in bytes. a cache line which also suits the widest simd registers
+#ifndef ECS_COLUMN_ALIGNMENT
+#define ECS_COLUMN_ALIGNMENT 64
+#endif
 
 namespace ecs {
 
 /**
- * Any component that is added to an entity must inherit from this struct.
+ * @brief Allocator handing out memory aligned to at least the given amount of bytes.
+ *
+ * @tparam T The type to allocate.
+ * @tparam Alignment The alignment in bytes, must be a power of two.
  */
-struct ComponentBase {
-    // empty constructor
-    ComponentBase() = default;
-
-    ECS*        ecs                 = nullptr;
-    ComponentID component_id         = ComponentID {};
-    ID          component_entity_id = INVALID_ID;
+template<typename T, std::size_t Alignment = ECS_COLUMN_ALIGNMENT>
+struct AlignedAllocator {
+    using value_type = T;
 
-    // when the component is removed from the entity
-    virtual void component_removed() {};
-
-    // when the entity is activated or deactivated
-    virtual void entity_activated() {};
-    virtual void entity_deactivated() {};
-
-    // when another component is added or removed
-    virtual void other_component_added(Hash hash) {};
-    virtual void other_component_removed(Hash hash) {};
+    static constexpr std::align_val_t alignment {
+        Alignment > alignof(T) ? Alignment : alignof(T)};
 
-    // get the hash of the component
-    virtual Hash get_hash() const {
-        return INVALID_HASH;
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
     };
-};
 
-template <typename T>
-struct ComponentOf : public ComponentBase {
-    // empty constructor
-    ComponentOf() = default;
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
 
-    // implement static hash function for components
-    static Hash hash() {
-        return get_type_hash<T>();
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), alignment));
     }
 
-    // override the non-static hash function to call the static one
-    virtual Hash get_hash() const override {
-        return hash();
+    void deallocate(T* ptr, std::size_t) noexcept {
+        ::operator delete(ptr, alignment);
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
     }
 };
 
-using ComponentPtr = std::unique_ptr<ComponentBase>;
+// contiguous array whose data is aligned to ECS_COLUMN_ALIGNMENT bytes
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
 
-} // namespace ecs_
+}    // namespace ecs
 
-#endif // ECS_ECS_COMPONENT_H_
+#endif    // ECS_ALIGNED_ALLOCATOR_H
 
 
-// end --- component.h --- 
+// end --- aligned_allocator.h --- 
 
 
 
-#include <memory>
-#include <unordered_map>
+// begin --- component_entity_list.h --- 
 
-namespace ecs {
+//
+// Created by Finn Eggers on 07.06.24.
+//
 
-/**
- * @brief Represents an entity in the ECS (Entity Component System).
- *
- * The Entity class manages a collection of components and provides methods
- * to add, remove, and access these components. It also supports basic operations
- * like checking for component existence and entity comparison.
- */
-struct Entity {
-    private:
-    // Unique identifier for the entity.
-    EntityID entity_id;
-    // Container for the entity's components.
-    std::unordered_map<Hash, ComponentPtr> components{};
-    // Pointer to the ECS that owns this entity.
-    ECSBase* ecs;
-    // Checks if its active or inactive.
-    bool m_active = false;
+#ifndef ECS_COMPONENT_ENTITY_LIST_H
+#define ECS_COMPONENT_ENTITY_LIST_H
 
-    // Grant ECS access to private members.
-    friend ECS;
-    friend ComponentEntityList;
+// begin --- vector_indexed.h --- 
 
-    public:
+//
+// Created by Finn Eggers on 16.10.26.
+//
 
-    // Copy constructor deleted but manual move constructor
-    Entity(const Entity& other) = delete;
+#ifndef ECS_VECTOR_INDEXED_H
+#define ECS_VECTOR_INDEXED_H
 
-    // Move constructor
-    Entity(Entity&& other) noexcept
-        : entity_id(other.entity_id)
-        , components(std::move(other.components))
-        , ecs(other.ecs)
-        , m_active(other.m_active) {
-        other.entity_id.id = INVALID_ID;
-        other.ecs = nullptr;
-        other.m_active = false;
-    }
+// begin --- vector_compact.h --- 
 
-    // Copy assignment operator
-    Entity& operator=(const Entity& other) = delete;
+//
+// Created by Finn Eggers on 08.06.24.
+//
 
-    // Move assignment operator
-    Entity& operator=(Entity&& other) noexcept {
-        if (this == &other)
-            return *this;
+#ifndef ECS_VECTOR_COMPACT_H
+#define ECS_VECTOR_COMPACT_H
 
-        remove_all_components();
+#include <algorithm>
+#include <iostream>
+#include <vector>
 
-        entity_id = other.entity_id;
-        components = std::move(other.components);
-        ecs = other.ecs;
-        m_active = other.m_active;
+// a normal vector more or less but when removing, we simply shift the last element to the position of the removed one
+// using templates to generalise for storage type
+namespace ecs {
 
-        other.entity_id.id = INVALID_ID;
-        other.ecs = nullptr;
-        other.m_active = false;
-        return *this;
+template<typename T>
+struct CompactVector {
+    std::vector<T> elements;
+
+    void push_back(const T &element) {
+        elements.push_back(element);
+        added(elements.size() - 1);
     }
+    void remove(const T &element) {
+        // check position of the element
+        ID element_id = index_of(element);
 
-    Entity(ECSBase* p_ecs = nullptr)
-        : entity_id{INVALID_ID}
-        , ecs(p_ecs) {}
+        // if it doesnt exist, exit here
+        if (element_id == INVALID_ID) {
+            return;
+        }
 
-    virtual ~Entity() {
-        remove_all_components();
+        remove_at(element_id);
     }
+    void remove_at(ID id) {
+        // if the element is at the end, we can simply pop it
+        if (id == elements.size() - 1) {
+            removed(id);
+            elements.pop_back();
+            return;
+        }
 
-    template<typename T>
-    bool has() const {
-        Hash hash = T::hash();
-        return components.find(hash) != components.end();
-    }
+        // otherwise we need to find the element and move the last element to its position
+        if (id < elements.size()) {
+            // get the id of the last element and the element to be removed
+            auto last_id = elements.size() - 1;
 
-    template<typename T, typename V, typename... Types>
-    bool has() const {
-        return has<T>() && has<V, Types...>();
-    }
+            removed(id);
 
-    template<typename T>
-    T* get() {
-        Hash hash = get_type_hash<T>();
-        if (components.find(hash) != components.end()) {
-            return static_cast<T*>(components.at(hash).get());
+            // move
+            elements[id] = elements.back();
+            elements.pop_back();
+
+            moved(last_id, id);
         }
-        return nullptr;
     }
+    auto begin() const { return elements.begin(); }
+    auto end() const { return elements.end(); }
 
-    template<typename T, typename... Args>
-    inline ComponentID assign(Args&&... args) {
-        auto component = std::make_unique<T>(std::forward<Args>(args)...);
-        Hash hashing   = T::hash();
+    // access operators + at()
+    T &operator[](ID id) { return elements[id]; }
+    T &at(ID id) { return elements.at(id); }
+    T &operator()(ID id) { return elements[id]; }
+    const T &operator[](ID id) const { return elements[id]; }
+    const T &at(ID id) const { return elements.at(id); }
+    const T &operator()(ID id) const { return elements[id]; }
 
-        // assign ecs to the component
-        component->ecs = reinterpret_cast<ECS*>(ecs);
-        // assign id
-        component->component_id = ComponentID{entity_id, hashing};
+    ID size() const { return elements.size(); }
+    void clear() { elements.clear(); }
+    void reserve(ID capacity) { elements.reserve(capacity); }
 
-        // If the component already exists, remove it first
-        if (has<T>()) {
-            remove_component<T>();
-        }
+    // position of the given element or INVALID_ID if it is not contained. searches linearly unless
+    // a derived container keeps track of the positions
+    virtual ID index_of(const T &element) const {
+        auto it = std::find(elements.begin(), elements.end(), element);
+        return it != elements.end() ? static_cast<ID>(std::distance(elements.begin(), it))
+                                    : INVALID_ID;
+    }
 
-        // Add the new component
-        components[hashing] = std::move(component);
-        ecs->component_added(hashing, id());
+    protected:
 
-        // notify all other components that a new component was added
-        for (auto& [hash, comp] : components) {
-            // dont do it for itself
-            if (hash == hashing)
-                continue;
+    virtual void moved(ID old_id, ID new_id) {};
+    virtual void removed(ID id) {};
+    virtual void added(ID id) {};
+};
 
-            // call the other_component_added function
-            comp->other_component_added(hash);
-            components[hashing]->other_component_added(hash);
-        }
+}    // namespace ecs_
 
-        // inform the component that it was added to an active entity
-        if (m_active) {
-            component->entity_activated();
-        }
+#endif    // ECS_VECTOR_COMPACT_H
 
-        // return the component id
-        return components[hashing]->component_id;
-    }
 
-    template<typename T>
-    inline void remove_component() {
-        if (!has<T>())
-            return;
+// end --- vector_compact.h --- 
 
-        Hash hash = get_type_hash<T>();
-        components[hash]->component_removed();
-        components.erase(hash);
-        ecs->component_removed(hash, id());
+
+
+#include <utility>
+#include <vector>
+
+// a compact vector of ids which additionally tracks the position of each id. this turns it into a
+// sparse set: lookups, insertions and removals by value are constant time while the ids remain
+// packed for iteration.
+namespace ecs {
+
+struct IndexedVector : CompactVector<ID> {
+    // position of each id within the vector, indexed by the id itself
+    std::vector<ID> indices {};
+
+    bool contains(ID id) const {
+        return id < indices.size() && indices[id] != INVALID_ID;
     }
 
-    inline void remove_all_components() {
-        for (auto& pair : components) {
-            ecs->component_removed(pair.first, id());
+    ID index_of(const ID& id) const override {
+        return contains(id) ? indices[id] : INVALID_ID;
+    }
+
+    void clear() {
+        CompactVector<ID>::clear();
+        indices.clear();
+    }
+
+    // exchanges the ids at the given positions
+    void swap_at(ID a, ID b) {
+        std::swap(elements[a], elements[b]);
+        indices[elements[a]] = a;
+        indices[elements[b]] = b;
+    }
+
+    protected:
+    void moved(ID from, ID to) override {
+        indices[elements[to]] = to;
+    }
+    void removed(ID id) override {
+        indices[elements[id]] = INVALID_ID;
+    }
+    void added(ID id) override {
+        if (elements[id] >= indices.size()) {
+            indices.resize(elements[id] + 1, INVALID_ID);
+        }
+        indices[elements[id]] = id;
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_VECTOR_INDEXED_H
+
+
+// end --- vector_indexed.h --- 
+
+
+
+namespace ecs {
+
+// dense list of the entities owning a component of a specific type. the position of an entity
+// in this list equals the position of its component within the pool of that type. the position
+// of each entity is tracked so that lookups and removals are constant time.
+struct ComponentEntityList : IndexedVector {
+    // hash of the component
+    Hash comp_hash_ = Hash{INVALID_HASH};
+
+    // set the component hash via some function to allow empty constructions
+    void set(Hash component_hash) {
+        this->comp_hash_ = component_hash;
+    }
+};
+
+}    // namespace ecs_
+
+#endif    // ECS_COMPONENT_ENTITY_LIST_H
+
+
+// end --- component_entity_list.h --- 
+
+
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Type-erased interface of a component pool.
+ *
+ * Every component type gets exactly one pool which is organised as a sparse set: the components
+ * are stored in a dense array, the entities owning them in a parallel dense array which also
+ * maps each entity id back to the position of its component. Lookups, insertions and removals
+ * are constant time and iterating a pool walks packed memory.
+ */
+struct ComponentPoolBase {
+    // dense array of the entities owning a component of this type
+    ComponentEntityList entities {};
+    // components of transient pools only live for one call to ECS::process()
+    bool                transient = false;
+
+    virtual ~ComponentPoolBase() = default;
+
+    bool contains(ID entity) const {
+        return entities.contains(entity);
+    }
+
+    ID index_of(ID entity) const {
+        return entities.index_of(entity);
+    }
+
+    ID size() const {
+        return entities.size();
+    }
+
+    // amount of components which fit into the storage without allocating
+    virtual ID capacity() const = 0;
+
+    // access the component of the given entity through its base
+    virtual ComponentBase* get_base(ID entity) = 0;
+
+    // removes the component of the given entity, moving the last component into its place
+    virtual void remove(ID entity) = 0;
+
+    // exchanges the components at the given positions
+    virtual void swap_at(ID a, ID b) = 0;
+
+    // removes all components
+    virtual void clear() = 0;
+};
+
+// one aligned array per field of a component declaring column_types, see ColumnsOf. components
+// storing their fields themselves get no columns
+template<typename T, typename = void>
+struct ColumnStorage {
+    using type = std::tuple<>;
+};
+
+template<typename T>
+struct ColumnStorage<T, std::void_t<typename T::column_types>> {
+    template<typename... Fields>
+    static std::tuple<AlignedVector<Fields>...> make(std::tuple<Fields...>*);
+
+    using type = decltype(make(static_cast<typename T::column_types*>(nullptr)));
+};
+
+// fixed size view onto a column, see ECS::column. the column cannot be resized through it since
+// it has to stay parallel to the components
+template<typename E>
+struct ColumnSpan {
+    E* values = nullptr;
+    ID count  = 0;
+
+    E* data() const {
+        return values;
+    }
+    ID size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    E& operator[](ID index) const {
+        return values[index];
+    }
+    E* begin() const {
+        return values;
+    }
+    E* end() const {
+        return values + count;
+    }
+};
+
+/**
+ * @brief Sparse set of components of type T.
+ *
+ * Components with column_types additionally keep one array per field, parallel to the components.
+ *
+ * @tparam T The component type stored in this pool.
+ */
+template<typename T>
+struct ComponentPool : public ComponentPoolBase {
+    using Component = T;
+    using Columns   = typename ColumnStorage<T>::type;
+
+    static constexpr bool columnar = std::tuple_size_v<Columns> > 0;
+
+    // dense array of the components, parallel to the entity list
+    std::vector<T>    components {};
+    // dense arrays of the fields of columnar components, parallel to the components
+    Columns           columns {};
+    // the tick at which each component was last accessed mutably, parallel to the components.
+    // kept apart from the components so marking a column as changed does not load them
+    std::vector<Tick> ticks {};
+
+    // columnar components are default constructed, the arguments initialise their fields instead
+    template<typename... Args>
+    T& emplace(ID entity, Args&&... args) {
+        if constexpr (columnar) {
+            components.emplace_back();
+            components.back().column_pool = this;
+            emplace_columns(std::index_sequence_for<Args...> {}, std::forward<Args>(args)...);
+        } else {
+            components.emplace_back(std::forward<Args>(args)...);
         }
-        for (auto& pair : components) {
-            pair.second->component_removed();
+        ticks.emplace_back();
+        entities.push_back(entity);
+        components.back().component_entity_id = components.size() - 1;
+        return components.back();
+    }
+
+    // reserves storage for the given amount of components
+    void reserve(ID capacity) {
+        components.reserve(capacity);
+        ticks.reserve(capacity);
+        entities.reserve(capacity);
+        std::apply([&](auto&... column) { (column.reserve(capacity), ...); }, columns);
+    }
+
+    // the values of the N-th field of all components
+    template<ID N>
+    auto& column() {
+        return std::get<N>(columns);
+    }
+
+    T* get(ID entity) {
+        ID index = index_of(entity);
+        return index != INVALID_ID ? &components[index] : nullptr;
+    }
+
+    // marks the components at the positions [begin, end) as changed at the given tick
+    void touch(ID begin, ID end, Tick tick) {
+        std::fill(ticks.data() + begin, ticks.data() + end, tick);
+    }
+
+    T& operator[](ID index) {
+        return components[index];
+    }
+
+    ID capacity() const override {
+        return components.capacity();
+    }
+
+    ComponentBase* get_base(ID entity) override {
+        return get(entity);
+    }
+
+    void remove(ID entity) override {
+        ID index = index_of(entity);
+        if (index == INVALID_ID)
+            return;
+
+        // swap and pop all dense arrays, the entity list updates its own positions
+        if (index != components.size() - 1) {
+            components[index]                     = std::move(components.back());
+            components[index].component_entity_id = index;
+            ticks[index]                          = ticks.back();
+            std::apply([&](auto&... column) { ((column[index] = std::move(column.back())), ...); },
+                       columns);
+        }
+        components.pop_back();
+        ticks.pop_back();
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, columns);
+        entities.remove_at(index);
+    }
+
+    void swap_at(ID a, ID b) override {
+        if (a == b)
+            return;
+        std::swap(components[a], components[b]);
+        components[a].component_entity_id = a;
+        components[b].component_entity_id = b;
+        std::swap(ticks[a], ticks[b]);
+        std::apply([&](auto&... column) { (std::swap(column[a], column[b]), ...); }, columns);
+        entities.swap_at(a, b);
+    }
+
+    // sorts the components at the positions [begin, end) by the given comparator
+    template<typename Compare>
+    void sort(ID begin, ID end, Compare compare, SortMode mode = SORT_FULL) {
+        if (mode == SORT_INSERTION) {
+            for (ID i = begin + 1; i < end; i++) {
+                for (ID j = i; j > begin && compare(components[j], components[j - 1]); j--) {
+                    swap_at(j, j - 1);
+                }
+            }
+            return;
+        }
+
+        // sort the positions first so the components are only moved once into place
+        std::vector<ID> order(end - begin);
+        std::iota(order.begin(), order.end(), begin);
+        std::sort(order.begin(), order.end(), [&](ID a, ID b) {
+            return compare(components[a], components[b]);
+        });
+
+        // follow the cycles of the permutation, order[i] marks position i as done once placed
+        for (ID i = begin; i < end; i++) {
+            ID current = i;
+            while (true) {
+                ID next                = order[current - begin];
+                order[current - begin] = current;
+                if (next == i || next == current)
+                    break;
+                swap_at(current, next);
+                current = next;
+            }
+        }
+    }
+
+    // keeps the components of the entities for which keep(entity) holds and removes all others in
+    // a single pass. unlike repeated removals, this preserves the order of the kept components
+    template<typename F>
+    void retain(F&& keep) {
+        ID kept = 0;
+        for (ID index = 0; index < components.size(); index++) {
+            ID entity = entities[index];
+            if (!keep(entity)) {
+                entities.indices[entity] = INVALID_ID;
+                continue;
+            }
+            if (kept != index) {
+                components[kept]                     = std::move(components[index]);
+                components[kept].component_entity_id = kept;
+                ticks[kept]                          = ticks[index];
+                entities[kept]                       = entity;
+                entities.indices[entity]             = kept;
+                std::apply([&](auto&... column) { ((column[kept] = std::move(column[index])), ...); },
+                           columns);
+            }
+            kept++;
         }
+        components.erase(components.begin() + kept, components.end());
+        ticks.resize(kept);
+        std::apply([&](auto&... column) { (column.erase(column.begin() + kept, column.end()), ...); },
+                   columns);
+        entities.elements.resize(kept);
+    }
 
+    void clear() override {
         components.clear();
+        ticks.clear();
+        std::apply([](auto&... column) { (column.clear(), ...); }, columns);
+        entities.clear();
+    }
+
+    private:
+    template<std::size_t... I, typename... Args>
+    void emplace_columns(std::index_sequence<I...>, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            std::apply([](auto&... column) { (column.emplace_back(), ...); }, columns);
+        } else {
+            static_assert(sizeof...(Args) == std::tuple_size_v<Columns>,
+                          "columnar components take either no arguments or one per field");
+            (std::get<I>(columns).emplace_back(std::forward<Args>(args)), ...);
+        }
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_COMPONENT_POOL_H
+
+
+// end --- component_pool.h --- 
+
+
+
+#include <memory>
+#include <vector>
+
+namespace ecs{
+
+struct ECSBase {
+    // one sparse set of components per component type, indexed by the component hash
+    std::vector<std::unique_ptr<ComponentPoolBase>> component_pools {};
+    // for each hook, the component types which override it
+    Signature                                       hooked[HOOK_COUNT] {};
+    // stamped into components when they are assigned or written. advanced after each stage of
+    // process(), so it is always larger than the tick at which any system last ran
+    Tick                                            change_tick = 1;
+
+    virtual ~ECSBase() = default;
+
+    // called before a component is taken out of its pool
+    virtual void component_removed(Hash, EntityID) = 0;
+    virtual void component_added(Hash, EntityID) = 0;
+
+    virtual void entity_activated(EntityID) = 0;
+    virtual void entity_deactivated(EntityID) = 0;
+
+    virtual void destroy_entity(EntityID) = 0;
+    virtual void destroy_system(SystemID) = 0;
+    virtual void destroy_listener(EventListenerID) = 0;
+
+    // returns the pool for the given component type, creating it if required
+    template<typename T>
+    ComponentPool<T>* pool() {
+        Hash hash = T::hash();
+        if (hash >= component_pools.size()) {
+            component_pools.resize(hash + 1);
+        }
+        auto& ptr = component_pools[hash];
+        if (!ptr) {
+            ptr = std::make_unique<ComponentPool<T>>();
+            ptr->entities.set(hash);
+            for (unsigned hook = 0; hook < HOOK_COUNT; hook++) {
+                hooked[hook].set(hash, T::overrides(ComponentHook(hook)));
+            }
+        }
+        return static_cast<ComponentPool<T>*>(ptr.get());
+    }
+
+    // returns the pool for the given component hash or nullptr if none exists yet
+    ComponentPoolBase* find_pool(Hash hash) const {
+        return hash < component_pools.size() ? component_pools[hash].get() : nullptr;
+    }
+};
+
+}
+
+#endif    // F3D_ECS_BASE_H
+
+
+// end --- ecs_base.h --- 
+
+
+
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <memory>
+
+namespace ecs {
+
+/**
+ * Any component that is added to an entity must inherit from this struct.
+ */
+struct ComponentBase {
+    // empty constructor
+    ComponentBase() = default;
+
+    ECS*        ecs                 = nullptr;
+    ComponentID component_id         = ComponentID {};
+    ID          component_entity_id = INVALID_ID;
+
+    // when the component is removed from the entity
+    virtual void component_removed() {};
+
+    // when the entity is activated or deactivated
+    virtual void entity_activated() {};
+    virtual void entity_deactivated() {};
+
+    // when another component is added or removed
+    virtual void other_component_added(Hash hash) {};
+    virtual void other_component_removed(Hash hash) {};
+
+    // get the hash of the component
+    virtual Hash get_hash() const {
+        return INVALID_HASH;
+    };
+};
+
+template <typename T>
+struct ComponentOf : public ComponentBase {
+    // empty constructor
+    ComponentOf() = default;
+
+    // implement static hash function for components
+    static Hash hash() {
+        return get_type_hash<T, ComponentBase>();
+    }
+
+    // override the non-static hash function to call the static one
+    virtual Hash get_hash() const override {
+        return hash();
+    }
+
+    // checks at compile time if T overrides the given hook. hooks which are not overridden are
+    // skipped entirely, so plain data components cost no virtual calls
+    static constexpr bool overrides(ComponentHook hook) {
+        switch (hook) {
+            case HOOK_COMPONENT_REMOVED: return overridden(&T::component_removed);
+            case HOOK_ENTITY_ACTIVATED: return overridden(&T::entity_activated);
+            case HOOK_ENTITY_DEACTIVATED: return overridden(&T::entity_deactivated);
+            case HOOK_OTHER_COMPONENT_ADDED: return overridden(&T::other_component_added);
+            default: return false;
+        }
+    }
+
+    private:
+    // &T::hook still names a member of ComponentBase unless T or one of its bases overrides it
+    template<typename R, typename... Args>
+    static constexpr bool overridden(R (ComponentBase::*)(Args...)) {
+        return false;
+    }
+    template<typename M>
+    static constexpr bool overridden(M) {
+        return true;
+    }
+};
+
+/**
+ * @brief Base for components whose fields are stored column-wise.
+ *
+ * Instead of living inside the component, the values of each field are kept in a separate aligned
+ * array within the pool. Systems touching only some fields of wide components then only load
+ * those, see ECS::column. The component accesses its own values through field<N>(), usually
+ * wrapped into named accessors. Assigning such a component takes either no arguments or one
+ * initial value per field. Views and queries can yield single fields directly, see Field.
+ *
+ * @tparam T The component type itself.
+ * @tparam Fields The types of the fields, one column each.
+ */
+template<typename T, typename... Fields>
+struct ColumnsOf : public ComponentOf<T> {
+    using column_types = std::tuple<Fields...>;
+
+    // the pool holding the columns, set when the component is assigned so that accessing a field
+    // requires no lookup
+    ComponentPool<T>* column_pool = nullptr;
+
+    // the value of the N-th field of this component
+    template<ID N>
+    std::tuple_element_t<N, column_types>& field();
+    template<ID N>
+    const std::tuple_element_t<N, column_types>& field() const;
+};
+
+} // namespace ecs_
+
+#endif // ECS_ECS_COMPONENT_H_
+
+
+// end --- component.h --- 
+
+
+
+#include <memory>
+#include <type_traits>
+
+namespace ecs {
+
+/**
+ * @brief Represents an entity in the ECS (Entity Component System).
+ *
+ * The Entity class provides methods to add, remove, and access the components
+ * of an entity. The components themselves live in the pools of the ECS. It also
+ * supports basic operations like checking for component existence and entity comparison.
+ */
+struct Entity {
+    private:
+    // Unique identifier for the entity.
+    EntityID entity_id;
+    // Pointer to the ECS that owns this entity.
+    ECSBase* ecs;
+    // One bit for each component type the entity owns.
+    Signature signature {};
+    // Checks if its active or inactive.
+    bool m_active = false;
+
+    // Grant ECS access to private members.
+    friend ECS;
+    friend ComponentEntityList;
+
+    public:
+
+    // Copy constructor deleted but manual move constructor
+    Entity(const Entity& other) = delete;
+
+    // Move constructor
+    Entity(Entity&& other) noexcept
+        : entity_id(other.entity_id)
+        , ecs(other.ecs)
+        , signature(other.signature)
+        , m_active(other.m_active) {
+        other.entity_id.id = INVALID_ID;
+        other.ecs = nullptr;
+        other.signature.reset();
+        other.m_active = false;
+    }
+
+    // Copy assignment operator
+    Entity& operator=(const Entity& other) = delete;
+
+    // Move assignment operator
+    Entity& operator=(Entity&& other) noexcept {
+        if (this == &other)
+            return *this;
+
+        entity_id = other.entity_id;
+        ecs = other.ecs;
+        signature = other.signature;
+        m_active = other.m_active;
+
+        other.entity_id.id = INVALID_ID;
+        other.ecs = nullptr;
+        other.signature.reset();
+        other.m_active = false;
+        return *this;
+    }
+
+    Entity(ECSBase* p_ecs = nullptr)
+        : entity_id{INVALID_ID}
+        , ecs(p_ecs) {}
+
+    // the components are owned by the pools of the ecs which releases them when the entity
+    // gets destroyed
+    virtual ~Entity() = default;
+
+    template<typename T>
+    bool has() const {
+        return signature.test(T::hash());
+    }
+
+    template<typename T, typename V, typename... Types>
+    bool has() const {
+        static const Signature mask = signature_of<T, V, Types...>();
+        return matches(mask);
+    }
+
+    // checks if the entity owns all component types within the given signature
+    bool matches(const Signature& mask) const {
+        return (signature & mask) == mask;
+    }
+
+    // same as above but the entity must not own any of the component types within excluded
+    bool matches(const Signature& mask, const Signature& excluded) const {
+        return (signature & mask) == mask && (signature & excluded).none();
+    }
+
+    // accessing a component mutably marks it as changed, see Changed. get<const T>() yields read-only
+    // access which leaves it untouched
+    template<typename T>
+    T* get() {
+        using Type = std::remove_const_t<T>;
+        if (!has<Type>()) {
+            return nullptr;
+        }
+        auto pool  = static_cast<ComponentPool<Type>*>(ecs->find_pool(Type::hash()));
+        ID   index = pool->index_of(entity_id.id);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = ecs->change_tick;
+        }
+        return &pool->components[index];
+    }
+
+    template<typename T, typename... Args>
+    inline ComponentID assign(Args&&... args) {
+        Hash hashing = T::hash();
+
+        // If the component already exists, remove it first
+        if (has<T>()) {
+            remove_component<T>();
+        }
+
+        // Add the new component to the end of its pool
+        ComponentPool<T>* pool      = ecs->pool<T>();
+        T&                component = pool->emplace(entity_id, std::forward<Args>(args)...);
+        // a new component counts as changed
+        pool->ticks.back() = ecs->change_tick;
+
+        // assign ecs to the component
+        component.ecs = reinterpret_cast<ECS*>(ecs);
+        // assign id
+        component.component_id = ComponentID{entity_id, hashing};
+
+        signature.set(hashing);
+
+        ecs->component_added(hashing, id());
+
+        // notify the other components that a new component was added. only components overriding
+        // the hook are visited, so this costs nothing for plain data components
+        const Signature& hooked = ecs->hooked[HOOK_OTHER_COMPONENT_ADDED];
+        for_each_component(hooked, [&](Hash hash, ComponentBase* comp) {
+            // dont do it for itself
+            if (hash != hashing) {
+                comp->other_component_added(hashing);
+            }
+        });
+        if constexpr (T::overrides(HOOK_OTHER_COMPONENT_ADDED)) {
+            for_each_component([&](Hash hash, ComponentBase*) {
+                if (hash != hashing) {
+                    get<T>()->other_component_added(hash);
+                }
+            });
+        }
+
+        // inform the component that it was added to an active entity
+        if constexpr (T::overrides(HOOK_ENTITY_ACTIVATED)) {
+            if (m_active) {
+                get<T>()->entity_activated();
+            }
+        }
+
+        // return the component id
+        return get<T>()->component_id;
+    }
+
+    template<typename T>
+    inline void remove_component() {
+        if (!has<T>())
+            return;
+
+        Hash hash = T::hash();
+        if constexpr (T::overrides(HOOK_COMPONENT_REMOVED)) {
+            get<T>()->component_removed();
+        }
+        // notify the ecs while the component is still part of its pool
+        ecs->component_removed(hash, id());
+        ecs->find_pool(hash)->remove(entity_id.id);
+        signature.reset(hash);
+    }
+
+    inline void remove_all_components() {
+        const Signature  owned  = signature;
+        const Signature& hooked = ecs->hooked[HOOK_COMPONENT_REMOVED];
+        // clear each component from the signature as it is reported, so queries and groups never
+        // see the entity with components that were already reported as removed
+        for_each_component([&](Hash hash, ComponentBase* comp) {
+            if (hooked.test(hash)) {
+                comp->component_removed();
+            }
+            signature.reset(hash);
+            ecs->component_removed(hash, id());
+        });
+        for (Hash hash = 0; hash < ecs->component_pools.size(); hash++) {
+            if (owned.test(hash)) {
+                ecs->component_pools[hash]->remove(entity_id.id);
+            }
+        }
     }
 
     inline void destroy() {
@@ -456,9 +1268,10 @@ struct Entity {
         if (!m_active) {
             m_active = true;
             ecs->entity_activated(this->entity_id);
-            for (auto& [hash, component] : components) {
-                component->entity_activated();
-            }
+            const Signature& hooked = ecs->hooked[HOOK_ENTITY_ACTIVATED];
+            for_each_component(hooked, [](Hash hash, ComponentBase* comp) {
+                comp->entity_activated();
+            });
         }
     }
 
@@ -466,9 +1279,10 @@ struct Entity {
         if (m_active) {
             m_active = false;
             ecs->entity_deactivated(this->entity_id);
-            for (auto& [hash, component] : components) {
-                component->entity_deactivated();
-            }
+            const Signature& hooked = ecs->hooked[HOOK_ENTITY_DEACTIVATED];
+            for_each_component(hooked, [](Hash hash, ComponentBase* comp) {
+                comp->entity_deactivated();
+            });
         }
     }
 
@@ -500,6 +1314,27 @@ struct Entity {
         return !(*this < rhs);
     }
 
+    private:
+    // calls the given function with the hash and the component for each component of the entity
+    template<typename F>
+    inline void for_each_component(F&& func) {
+        for_each_component(signature, func);
+    }
+
+    // same as above but restricted to the component types within the given mask
+    template<typename F>
+    inline void for_each_component(const Signature& mask, F&& func) {
+        Signature selected = signature & mask;
+        if (selected.none())
+            return;
+        for (Hash hash = 0; hash < ecs->component_pools.size(); hash++) {
+            if (selected.test(hash)) {
+                func(hash, ecs->component_pools[hash]->get_base(entity_id.id));
+            }
+        }
+    }
+
+    public:
     // Stream output to display hash, id, valid, active all nicely in new rows indented
     friend std::ostream& operator<<(std::ostream& os, const Entity& entity) {
         os << "Entity ID: " << entity.entity_id << std::endl;
@@ -533,8 +1368,11 @@ struct EntityIterator {
 
     EntityIterator(std::vector<ID>::iterator id_iter,
                    std::vector<ID>::iterator id_end,
-                   std::vector<Entity>* entity_packs)
-        : m_id_iter(id_iter), m_id_end(id_end), m_entity_packs(entity_packs) {
+                   std::vector<Entity>* entity_packs,
+                   const Signature& mask,
+                   const Signature& excluded)
+        : m_id_iter(id_iter), m_id_end(id_end), m_entity_packs(entity_packs), m_mask(mask),
+          m_excluded(excluded) {
 
         advance_to_next_valid();
     }
@@ -573,11 +1411,15 @@ struct EntityIterator {
     std::vector<ID>::iterator m_id_iter;
     std::vector<ID>::iterator m_id_end;
     std::vector<Entity>* m_entity_packs;
+    Signature m_mask;
+    Signature m_excluded;
 
     void advance_to_next_valid() {
 
+        // the component lists also contain inactive entities which are skipped here
         while (   m_id_iter != m_id_end
-               && !(*m_entity_packs)[*m_id_iter].template has<RTypes...>()) {
+               && !(   (*m_entity_packs)[*m_id_iter].active()
+                    && (*m_entity_packs)[*m_id_iter].matches(m_mask, m_excluded))) {
 
             // if id is IVALID_ID, skip
             if (*m_id_iter == INVALID_ID) {
@@ -599,23 +1441,273 @@ struct EntityIterator {
 
 
 
+// begin --- terms.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_TERMS_H
+#define ECS_TERMS_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ecs {
+
+// query term excluding all entities which own any of the given component types
+template<typename... Types>
+struct Without {};
+
+// query term yielding a pointer to the component, which is nullptr if the entity does not own one
+template<typename T>
+struct Optional {};
+
+// view and query term yielding a reference to the N-th field of the columnar component T, see
+// ColumnsOf. the column is looked up once per iteration, so only the field itself is touched
+template<typename T, ID N>
+struct Field {};
+
+// view term requiring the component to have changed after the tick the view was created for,
+// see ECS::view. it yields nothing, so it is usually combined with T or const T
+template<typename T>
+struct Changed {};
+
+/**
+ * @brief Describes how a term of a query restricts the entities and what it yields for them.
+ *
+ * Plain component types are required and yield a reference to the component. Accessing it this
+ * way marks the component as changed at the current tick, see Changed, and therefore counts as a
+ * write of T for scheduling, see System::writes. Const component types yield a const reference
+ * and leave the component untouched. The same holds for the component types of Optional and
+ * Field. See Without, Optional, Field and Changed for the other terms.
+ */
+template<typename T>
+struct Term {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = true;
+    // terms which look at the components themselves to decide if an entity matches
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<T&> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool->index_of(entity);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {pool->components[index]};
+    }
+};
+
+template<typename... Types>
+struct Term<Without<Types...>> {
+    static constexpr bool required = false;
+    static constexpr bool filtered = false;
+    using Pool                     = std::nullptr_t;
+
+    static Signature required_mask() {
+        return Signature {};
+    }
+    static Signature excluded_mask() {
+        return signature_of<Types...>();
+    }
+    static Pool find(ECSBase*) {
+        return nullptr;
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<> get(Pool, ID, Tick) {
+        return {};
+    }
+};
+
+template<typename T>
+struct Term<Optional<T>> {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = false;
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return Signature {};
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<T*> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool != nullptr ? pool->index_of(entity) : INVALID_ID;
+        if (index == INVALID_ID)
+            return {nullptr};
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {&pool->components[index]};
+    }
+};
+
+template<typename T, ID N>
+struct Term<Field<T, N>> {
+    using Type    = std::remove_const_t<T>;
+    using Element = std::tuple_element_t<N, typename Type::column_types>;
+    using Value   = std::conditional_t<std::is_const_v<T>, const Element&, Element&>;
+
+    static constexpr bool required = true;
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<Value> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool->index_of(entity);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {pool->template column<N>()[index]};
+    }
+};
+
+template<typename T>
+struct Term<Changed<T>> {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = true;
+    static constexpr bool filtered = true;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool pool, ID entity, Tick since) {
+        return pool->ticks[pool->index_of(entity)] > since;
+    }
+    static std::tuple<> get(Pool, ID, Tick) {
+        return {};
+    }
+};
+
+// true if none of the given terms needs to look at the components to decide if an entity matches
+template<typename... Terms>
+constexpr bool unfiltered = !(Term<Terms>::filtered || ...);
+
+// the component types an entity must own to match the given terms
+template<typename... Terms>
+Signature required_of() {
+    Signature signature {};
+    ((signature |= Term<Terms>::required_mask()), ...);
+    return signature;
+}
+
+// the component types an entity must not own to match the given terms
+template<typename... Terms>
+Signature excluded_of() {
+    Signature signature {};
+    ((signature |= Term<Terms>::excluded_mask()), ...);
+    return signature;
+}
+
+// the pools accessed by the given terms
+template<typename... Terms>
+using TermPools = std::tuple<typename Term<Terms>::Pool...>;
+
+template<typename... Terms>
+TermPools<Terms...> find_term_pools(ECSBase* ecs) {
+    return TermPools<Terms...> {Term<Terms>::find(ecs)...};
+}
+
+// checks the filtering terms for an entity which owns all required component types
+template<typename... Terms, std::size_t... I>
+bool term_accepts(ID id, const TermPools<Terms...>& pools, Tick since, std::index_sequence<I...>) {
+    return (Term<Terms>::accepts(std::get<I>(pools), id, since) && ...);
+}
+
+// the tuple of the entity id followed by the values yielded by each term. components accessed
+// mutably are stamped with the given tick
+template<typename... Terms, std::size_t... I>
+auto term_values(EntityID                   id,
+                 const TermPools<Terms...>& pools,
+                 Tick                       tick,
+                 std::index_sequence<I...>) {
+    return std::tuple_cat(std::tuple<EntityID> {id},
+                          Term<Terms>::get(std::get<I>(pools), id, tick)...);
+}
+
+template<typename... Terms>
+using TermValues = decltype(term_values<Terms...>(EntityID {},
+                                                  std::declval<const TermPools<Terms...>&>(),
+                                                  Tick {},
+                                                  std::index_sequence_for<Terms...> {}));
+
+}    // namespace ecs
+
+#endif    // ECS_TERMS_H
+
+
+// end --- terms.h --- 
+
+
+
 namespace ecs {
 
 template<typename... RTypes>
 struct EntitySubSet {
+    static_assert(unfiltered<RTypes...>, "Changed terms are only supported by views");
+
     std::vector<ID>* ids;
     std::vector<Entity>* entries;
+    // the component types each entity must and must not own, computed once for the query
+    Signature mask;
+    Signature excluded;
 
     EntitySubSet(std::vector<ID>* ids, std::vector<Entity>* entries)
-        : ids(ids), entries(entries) {
+        : ids(ids), entries(entries), mask(required_of<RTypes...>()),
+          excluded(excluded_of<RTypes...>()) {
     }
 
     EntityIterator<RTypes...> begin() {
-        return EntityIterator<RTypes...> {ids->begin(), ids->end(), entries};
+        return EntityIterator<RTypes...> {ids->begin(), ids->end(), entries, mask, excluded};
     }
 
     EntityIterator<RTypes...> end() {
-        return EntityIterator<RTypes...> {ids->end(), ids->end(), entries};
+        return EntityIterator<RTypes...> {ids->end(), ids->end(), entries, mask, excluded};
     }
 };
 }
@@ -646,161 +1738,432 @@ struct EntitySubSet {
 #ifndef ECS_ECS_ECS_H_
 #define ECS_ECS_ECS_H_
 
-// begin --- component_entity_list.h --- 
+// begin --- command_buffer.h --- 
 
 //
-// Created by Finn Eggers on 07.06.24.
+// Created by Finn Eggers on 16.10.26.
 //
 
-#ifndef ECS_COMPONENT_ENTITY_LIST_H
-#define ECS_COMPONENT_ENTITY_LIST_H
+#ifndef ECS_COMMAND_BUFFER_H
+#define ECS_COMMAND_BUFFER_H
 
-// begin --- vector_compact.h --- 
+#include <functional>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Records structural changes to apply them to the ECS later on.
+ *
+ * Spawning or destroying entities and adding or removing components while iterating the ECS
+ * invalidates the iterators. Such changes are recorded here instead and applied in bulk once it
+ * is safe, either by ECS::flush_commands() or automatically between the stages of
+ * ECS::process(). Each thread records into its own buffer obtained from ECS::commands().
+ *
+ * Commands referring to entities which have been destroyed in the meantime are skipped.
+ */
+struct CommandBuffer {
+    struct Command {
+        // entity the command applies to, INVALID_ID for spawns
+        ID                        entity;
+        std::function<void(ECS&)> apply;
+    };
+
+    std::vector<Command> commands {};
+
+    // spawns an entity and optionally calls init(entity) to set it up
+    void spawn(bool active = false);
+    template<typename F>
+    void spawn(bool active, F&& init);
+
+    void destroy_entity(EntityID id);
+
+    template<typename T, typename... Args>
+    void assign(EntityID id, Args&&... args);
+
+    template<typename T>
+    void remove_component(EntityID id);
+
+    void activate(EntityID id);
+    void deactivate(EntityID id);
+
+    bool empty() const {
+        return commands.empty();
+    }
+
+    ID size() const {
+        return commands.size();
+    }
+
+    void clear() {
+        commands.clear();
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_COMMAND_BUFFER_H
+
+
+// end --- command_buffer.h --- 
+
+
+
+// begin --- group.h --- 
 
 //
-// Created by Finn Eggers on 08.06.24.
+// Created by Finn Eggers on 16.10.26.
 //
 
-#ifndef ECS_VECTOR_COMPACT_H
-#define ECS_VECTOR_COMPACT_H
+#ifndef ECS_GROUP_H
+#define ECS_GROUP_H
 
-#include <algorithm>
-#include <iostream>
+#include <iterator>
+#include <tuple>
 #include <vector>
 
-// a normal vector more or less but when removing, we simply shift the last element to the position of the removed one
-// using templates to generalise for storage type
 namespace ecs {
 
-template<typename T>
-struct CompactVector {
-    std::vector<T> elements;
+// type-erased part of an owning group which the ecs keeps up to date
+struct GroupBase {
+    // the owned component types
+    Signature                       mask {};
+    std::vector<ComponentPoolBase*> pools {};
+    // the entities owning all of the types are stored at the first size positions of every pool
+    ID                              size = 0;
 
-    void push_back(const T &element) {
-        elements.push_back(element);
+    virtual ~GroupBase() = default;
+
+    bool contains(ID entity) const {
+        ID index = pools[0]->index_of(entity);
+        return index != INVALID_ID && index < size;
     }
-    void remove(const T &element) {
-        // if the element is at the end, we can simply pop it
-        if (element == elements.back()) {
-            elements.pop_back();
-            removed(element);
-            return;
+
+    // moves the components of the entity to the end of the group within every pool
+    void join(ID entity) {
+        for (ComponentPoolBase* pool : pools) {
+            pool->swap_at(pool->index_of(entity), size);
         }
+        size++;
+    }
 
-        // check position of the element
-        auto it = std::find(elements.begin(), elements.end(), element);
+    // moves the components of the entity right behind the group within every pool
+    void leave(ID entity) {
+        size--;
+        for (ComponentPoolBase* pool : pools) {
+            pool->swap_at(pool->index_of(entity), size);
+        }
+    }
+};
 
-        // if it doesnt exist, exit here
-        if (it == elements.end()) {
-            return;
+/**
+ * @brief Owning group keeping the pools of the given component types sorted in lockstep.
+ *
+ * Entities owning all of the types are moved to the front of every owned pool in the same order,
+ * so the components at position i of each pool belong to the same entity. Iterating a group is a
+ * parallel linear scan over the pools, which ECS::for_each_chunk over the same types benefits from
+ * as well. Each component type can be owned by a single group only.
+ *
+ * @tparam Types The owned component types.
+ */
+template<typename... Types>
+struct Group : GroupBase {
+    using value_type = std::tuple<EntityID, Types&...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Group::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const Group* group, ID position)
+            : m_group(group), m_position(position) {
+            advance_to_next_valid();
         }
 
-        // otherwise we need to find the element and move the last element to its position
-        if (it != elements.end()) {
-            // get the id of the last element and the element to be removed
-            auto last_id = elements.size() - 1;
-            auto element_id = static_cast<ID>(std::distance(elements.begin(), it));
+        // the components are yielded as mutable references and therefore marked as changed
+        reference operator*() const {
+            auto& first = *std::get<0>(m_group->typed_pools);
+            ((std::get<ComponentPool<Types>*>(m_group->typed_pools)->ticks[m_position] =
+                  *m_group->tick),
+             ...);
+            return value_type {(*m_group->entities)[first.entities[m_position]].id(),
+                               std::get<ComponentPool<Types>*>(m_group->typed_pools)
+                                   ->components[m_position]...};
+        }
 
-            removed(element_id);
+        iterator& operator++() {
+            ++m_position;
+            advance_to_next_valid();
+            return *this;
+        }
 
-            // move
-            elements[element_id] = elements.back();
-            elements.pop_back();
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
 
-            moved(last_id, element_id);
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
         }
-    }
-    void remove_at(ID id) {
-        // if the element is at the end, we can simply pop it
-        if (id == elements.size() - 1) {
-            elements.pop_back();
-            removed(id);
-            return;
+
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
         }
 
-        // otherwise we need to find the element and move the last element to its position
-        if (id < elements.size()) {
-            // get the id of the last element and the element to be removed
-            auto last_id = elements.size() - 1;
+        private:
+        const Group* m_group;
+        ID           m_position;
 
-            removed(id);
+        // skips inactive entities
+        void advance_to_next_valid() {
+            auto& first = *std::get<0>(m_group->typed_pools);
+            while (m_position < m_group->size
+                   && !(*m_group->entities)[first.entities[m_position]].active()) {
+                ++m_position;
+            }
+        }
+    };
 
-            // move
-            elements[id] = elements.back();
-            elements.pop_back();
+    std::vector<Entity>*                 entities;
+    // the current tick of the ecs, see Changed
+    const Tick*                          tick;
+    std::tuple<ComponentPool<Types>*...> typed_pools;
 
-            moved(last_id, id);
-        }
+    Group(std::vector<Entity>* entries, const Tick* clock, ComponentPool<Types>*... owned)
+        : entities(entries), tick(clock), typed_pools(owned...) {
+        mask  = signature_of<Types...>();
+        pools = {owned...};
     }
-    auto begin() const { return elements.begin(); }
-    auto end() const { return elements.end(); }
 
-    // access operators + at()
-    T &operator[](ID id) { return elements[id]; }
-    T &at(ID id) { return elements.at(id); }
-    T &operator()(ID id) { return elements[id]; }
-    const T &operator[](ID id) const { return elements[id]; }
-    const T &at(ID id) const { return elements.at(id); }
-    const T &operator()(ID id) const { return elements[id]; }
+    iterator begin() const {
+        return iterator {this, 0};
+    }
 
-    ID size() const { return elements.size(); }
-    void clear() { elements.clear(); }
+    iterator end() const {
+        return iterator {this, size};
+    }
+};
 
-    protected:
+}    // namespace ecs
 
-    virtual void moved(ID old_id, ID new_id) {};
-    virtual void removed(ID id) {};
-    virtual void added(ID id) {};
+#endif    // ECS_GROUP_H
+
+
+// end --- group.h --- 
+
+
+
+// begin --- observer.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_OBSERVER_H
+#define ECS_OBSERVER_H
+
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Buffers the entities affected by one kind of structural change until they are drained.
+ *
+ * Observers are registered by ECS::observe_added, ECS::observe_removed and ECS::observe_entered.
+ * Instead of calling back into user code for every change, the ecs only appends the id of the
+ * affected entity, and a system handles all of them at once, usually once per frame.
+ */
+struct Observer {
+    // the affected entities in the order of the changes. an entity is recorded once per change, so
+    // it may be listed repeatedly and may have been destroyed by the time the observer is drained
+    std::vector<EntityID> entities {};
+
+    void record(EntityID id) {
+        entities.push_back(id);
+    }
+
+    ID size() const {
+        return entities.size();
+    }
+
+    bool empty() const {
+        return entities.empty();
+    }
+
+    // calls func(id) for each recorded entity and clears the buffer. changes caused by func are
+    // recorded for the next drain
+    template<typename F>
+    void drain(F&& func) {
+        std::vector<EntityID> drained {};
+        drained.swap(entities);
+        for (EntityID id : drained) {
+            func(id);
+        }
+        // keep the storage unless func recorded further changes
+        if (entities.empty()) {
+            drained.clear();
+            entities.swap(drained);
+        }
+    }
+
+    void clear() {
+        entities.clear();
+    }
 };
 
-}    // namespace ecs_
+}    // namespace ecs
+
+#endif    // ECS_OBSERVER_H
+
+
+// end --- observer.h --- 
+
+
+
+// begin --- query.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_QUERY_H
+#define ECS_QUERY_H
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace ecs {
+
+// type-erased part of a query which the ecs keeps up to date
+struct QueryBase {
+    // the component types an entity must own and those it must not own
+    Signature              mask {};
+    Signature              excluded {};
+    // the active entities matching both
+    IndexedVector          matches {};
+    // observers recording the entities which start matching, see ECS::observe_entered
+    std::vector<Observer*> entered {};
+
+    virtual ~QueryBase() = default;
+
+    // checks if an entity owning the given component types would match
+    bool accepts(const Signature& signature) const {
+        return (signature & mask) == mask && (signature & excluded).none();
+    }
 
-#endif    // ECS_VECTOR_COMPACT_H
+    // adds or removes the entity depending on whether it currently matches
+    void update(const Entity& entity) {
+        update(entity.id(), entity.active() && entity.matches(mask, excluded));
+    }
 
+    void update(EntityID entity, bool matching) {
+        if (matching && !matches.contains(entity.id)) {
+            matches.push_back(entity.id);
+            for (Observer* observer : entered) {
+                observer->record(entity);
+            }
+        } else if (!matching && matches.contains(entity.id)) {
+            matches.remove(entity.id);
+        }
+    }
+};
 
-// end --- vector_compact.h --- 
+/**
+ * @brief Persistent query over the active entities owning all given components.
+ *
+ * Queries are registered once by ECS::query and the ecs updates their list of matching entities
+ * whenever components are added or removed and entities are activated or deactivated. Iterating
+ * a query therefore walks its matches without filtering, yielding the same tuples as a View.
+ *
+ * @tparam Terms The component types each entity must own and further terms.
+ */
+template<typename... Terms>
+struct Query : QueryBase {
+    static_assert(unfiltered<Terms...>, "Changed terms are only supported by views");
+
+    using value_type = TermValues<Terms...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Query::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const Query* query, TermPools<Terms...> pools, ID position)
+            : m_query(query), m_pools(pools), m_position(position) {}
+
+        reference operator*() const {
+            ID id = m_query->matches[m_position];
+            return term_values<Terms...>((*m_query->entities)[id].id(),
+                                         m_pools,
+                                         m_query->ecs->change_tick,
+                                         std::index_sequence_for<Terms...> {});
+        }
 
+        iterator& operator++() {
+            ++m_position;
+            return *this;
+        }
 
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
 
-#include <vector>
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
+        }
 
-namespace ecs {
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
+        }
 
-struct ComponentEntityList : CompactVector<ID> {
-    // pointer to the ECS
-    std::vector<Entity>* entities_ = nullptr;
+        private:
+        const Query*        m_query;
+        TermPools<Terms...> m_pools;
+        ID                  m_position;
+    };
 
-    // hash of the component
-    Hash comp_hash_ = Hash{INVALID_HASH};
+    ECSBase*             ecs;
+    std::vector<Entity>* entities;
 
-    // set ecs_ and component hash via some function to allow empty constructions
-    void set(std::vector<Entity>* entities, Hash component_hash) {
-        this->entities_      = entities;
-        this->comp_hash_     = component_hash;
+    Query(ECSBase* owner, std::vector<Entity>* entries)
+        : ecs(owner), entities(entries) {
+        mask     = required_of<Terms...>();
+        excluded = excluded_of<Terms...>();
     }
 
-    // overloaded
-    void moved(ID from, ID to) override {
-        // TODO
-//        (*entities_)[elements[to]].components[comp_hash_]->component_entity_id = to;
+    ID size() const {
+        return matches.size();
     }
-    void removed(ID id) override {
-        // TODO
-//        (*entities_)[elements[id]].components[comp_hash_]->component_entity_id = INVALID_ID;
+
+    // the pools are looked up once per iteration. if one is missing, there are no matches either
+    iterator begin() const {
+        return iterator {this, pools(), 0};
     }
-    void added(ID id) override {
-        // TODO
-//        (*entities_)[elements[id]].components[comp_hash_]->component_entity_id = id;
+
+    iterator end() const {
+        return iterator {this, pools(), matches.size()};
     }
 
+    private:
+    TermPools<Terms...> pools() const {
+        return find_term_pools<Terms...>(ecs);
+    }
 };
 
-}    // namespace ecs_
+}    // namespace ecs
 
-#endif    // ECS_COMPONENT_ENTITY_LIST_H
+#endif    // ECS_QUERY_H
 
 
-// end --- component_entity_list.h --- 
+// end --- query.h --- 
 
 
 
@@ -822,9 +2185,57 @@ struct System {
 
     friend struct ECS;
 
+    // component types the system reads and writes
+    const Signature& read_access() const {
+        return m_reads;
+    }
+    const Signature& write_access() const {
+        return m_writes;
+    }
+    bool declares_access() const {
+        return m_declared;
+    }
+
+    // the tick at which the system last ran or zero if it never did. pass it to ECS::view to only
+    // visit the components changed since then
+    Tick last_run() const {
+        return m_last_run;
+    }
+
+    // two systems conflict if one of them writes what the other one accesses. systems which did
+    // not declare their access may touch anything and therefore conflict with every other system
+    bool conflicts_with(const System& other) const {
+        if (!m_declared || !other.m_declared)
+            return true;
+        return (m_writes & (other.m_reads | other.m_writes)).any()
+               || (other.m_writes & m_reads).any();
+    }
+
     protected:
+    // declare the components accessed within process(), usually from the constructor of the system.
+    // any mutable access marks components as changed, see Changed, and therefore is a write: this
+    // includes non-const view and query terms, Entity::get<T>, groups, for_each_chunk and column.
+    // systems which only declare reads<T> must access T as const T, e.g. view<const T>() or
+    // get<const T>(), since systems reading the same types run concurrently
+    template<typename... Types>
+    void reads() {
+        m_reads |= signature_of<Types...>();
+        m_declared = true;
+    }
+    template<typename... Types>
+    void writes() {
+        m_writes |= signature_of<Types...>();
+        m_declared = true;
+    }
+
     virtual void process(ECS* ecs, double delta) = 0;
     virtual void destroyed() {};
+
+    private:
+    Signature m_reads {};
+    Signature m_writes {};
+    bool      m_declared = false;
+    Tick      m_last_run = 0;
 };
 
 }    // namespace ecs_
@@ -836,6 +2247,15 @@ struct System {
 
 
 
+// begin --- system_schedule.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SYSTEM_SCHEDULE_H
+#define ECS_SYSTEM_SCHEDULE_H
+
 // begin --- vector_recycling.h --- 
 
 //
@@ -958,9 +2378,555 @@ struct RecyclingVector {
 
 
 #include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Order in which the systems of an ECS are processed.
+ *
+ * A system depends on every system registered before it which it conflicts with, i.e. one of
+ * both writes a component the other one accesses. These dependencies form a DAG which is split
+ * into stages: each system is placed one stage after the last of its dependencies. Systems within
+ * a stage never conflict and run concurrently, the stages run one after another.
+ */
+struct SystemSchedule {
+    // systems which have to finish before a system may start, indexed by the system id
+    std::vector<std::vector<SystemID>> dependencies {};
+    // groups of systems which run concurrently, processed in order
+    std::vector<std::vector<SystemID>> stages {};
+
+    void build(const RecyclingVector<System::Ptr>& systems) {
+        dependencies.assign(systems.size(), {});
+        stages.clear();
+
+        std::vector<ID> stage_of(systems.size(), 0);
+        for (ID id = 0; id < systems.size(); id++) {
+            if (!systems[id])
+                continue;
+
+            ID stage = 0;
+            for (ID prev = 0; prev < id; prev++) {
+                if (systems[prev] && systems[id]->conflicts_with(*systems[prev])) {
+                    dependencies[id].push_back(SystemID {prev});
+                    stage = std::max(stage, stage_of[prev] + 1);
+                }
+            }
+
+            stage_of[id] = stage;
+            if (stage >= stages.size()) {
+                stages.resize(stage + 1);
+            }
+            stages[stage].push_back(SystemID {id});
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const SystemSchedule& schedule) {
+        os << "System Schedule: " << std::endl;
+        os << "-----------------" << std::endl;
+        for (ID stage = 0; stage < schedule.stages.size(); stage++) {
+            os << "Stage " << stage << ":";
+            for (const auto& id : schedule.stages[stage]) {
+                os << " " << id.id;
+            }
+            os << std::endl;
+        }
+        return os;
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_SYSTEM_SCHEDULE_H
+
+
+// end --- system_schedule.h --- 
+
+
+
+// begin --- thread_pool.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_THREAD_POOL_H
+#define ECS_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecs {
+
+// statistics of a thread pool, either of a single thread or accumulated over all of them
+struct ThreadPoolStats {
+    // jobs executed
+    ID     jobs_run  = 0;
+    // jobs taken from the queue of another thread
+    ID     steals    = 0;
+    // seconds spent waiting for jobs
+    double idle_time = 0;
+};
+
+/**
+ * @brief Work-stealing job system.
+ *
+ * Each worker owns a deque of jobs. Jobs submitted by a worker go to the back of its own deque
+ * and are taken from there again, so related work stays on the same thread. Workers running out
+ * of jobs steal the oldest job from the front of another deque. Jobs submitted by threads outside
+ * of the pool go to a shared deque which is treated like the one of an additional worker.
+ *
+ * The workers are only started once the first job is submitted, so an ECS which never runs
+ * anything in parallel never spawns a thread. Threads waiting for jobs to finish help processing
+ * them instead of blocking, which allows jobs to submit and wait for further jobs.
+ */
+struct ThreadPool {
+    using Job = std::function<void()>;
+
+    // thread_count includes the calling thread. zero picks the amount of hardware threads
+    explicit ThreadPool(ID thread_count = 0) {
+        set_thread_count(thread_count);
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        stop();
+    }
+
+    // amount of threads taking part in parallel work, including the calling one
+    ID size() const {
+        return thread_count_;
+    }
+
+    // changes the amount of threads. finishes all queued jobs first and must not be called
+    // from within a job
+    void set_thread_count(ID thread_count) {
+        stop();
+        thread_count_ = thread_count > 0 ? thread_count
+                                         : std::max<ID>(1, std::thread::hardware_concurrency());
+        slots_.clear();
+        for (ID i = 0; i < thread_count_; i++) {
+            slots_.push_back(std::make_unique<Slot>());
+        }
+    }
+
+    // queues a job. runs it right away if there are no workers
+    void submit(Job job) {
+        if (thread_count_ <= 1) {
+            job();
+            return;
+        }
+        start();
+
+        Slot& slot = *slots_[current_slot()];
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            slot.jobs.push_back(std::move(job));
+            pending_++;
+        }
+        {
+            // synchronise with workers about to fall asleep so the notification is not lost
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_condition_.notify_one();
+    }
+
+    // runs one queued job on the calling thread, preferring its own queue over stealing.
+    // returns false if there was no job to run
+    bool run_pending() {
+        if (pending_ == 0)
+            return false;
+
+        ID  self = current_slot();
+        Job job;
+        if (pop_back(self, job)) {
+            slots_[self]->jobs_run++;
+            job();
+            return true;
+        }
+        for (ID offset = 1; offset < slots_.size(); offset++) {
+            ID victim = (self + offset) % slots_.size();
+            if (steal_front(victim, job)) {
+                slots_[self]->steals++;
+                slots_[self]->jobs_run++;
+                job();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Fork/join helper to wait for a set of jobs.
+     *
+     * Jobs are forked with run() and joined with wait(), which processes pending jobs of the
+     * pool until all jobs of the group finished. The destructor waits as well.
+     */
+    struct JobGroup {
+        explicit JobGroup(ThreadPool& pool)
+            : pool_(pool) {}
+
+        JobGroup(const JobGroup&)            = delete;
+        JobGroup& operator=(const JobGroup&) = delete;
+
+        ~JobGroup() {
+            wait();
+        }
+
+        void run(Job job) {
+            remaining_++;
+            pool_.submit([this, job = std::move(job)] {
+                job();
+                remaining_--;
+            });
+        }
+
+        void wait() {
+            while (remaining_ > 0) {
+                if (!pool_.run_pending()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        private:
+        ThreadPool&     pool_;
+        std::atomic<ID> remaining_ {0};
+    };
+
+    // runs all given functions in parallel and returns once all of them finished
+    template<typename... F>
+    void invoke(F&&... funcs) {
+        JobGroup group {*this};
+        (group.run(std::forward<F>(funcs)), ...);
+        group.wait();
+    }
+
+    /**
+     * @brief Splits the range [begin, end) into chunks and processes them in parallel.
+     *
+     * The calling thread processes the first chunk itself and helps with the remaining ones
+     * until all of them are done.
+     *
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param grain_size Amount of indices per chunk. Zero picks a few chunks per thread.
+     * @param func Called as func(chunk_begin, chunk_end) for each chunk.
+     */
+    template<typename F>
+    void parallel_for(ID begin, ID end, ID grain_size, F&& func) {
+        if (begin >= end)
+            return;
+
+        ID count = end - begin;
+        if (grain_size == 0) {
+            grain_size = std::max<ID>(1, count / (thread_count_ * 4));
+        }
+
+        ID chunks = (count + grain_size - 1) / grain_size;
+        if (chunks == 1 || thread_count_ <= 1) {
+            func(begin, end);
+            return;
+        }
+
+        JobGroup group {*this};
+        for (ID chunk = 1; chunk < chunks; chunk++) {
+            ID chunk_begin = begin + chunk * grain_size;
+            ID chunk_end   = std::min(end, chunk_begin + grain_size);
+            group.run([&func, chunk_begin, chunk_end] { func(chunk_begin, chunk_end); });
+        }
+
+        func(begin, begin + grain_size);
+        group.wait();
+    }
+
+    // statistics of a single thread. thread 0 covers all threads outside of the pool
+    ThreadPoolStats stats(ID thread) const {
+        const Slot& slot = *slots_[thread];
+        return ThreadPoolStats {slot.jobs_run,
+                               slot.steals,
+                               static_cast<double>(slot.idle_nanoseconds.load()) * 1e-9};
+    }
+
+    // statistics accumulated over all threads
+    ThreadPoolStats stats() const {
+        ThreadPoolStats total {};
+        for (ID thread = 0; thread < slots_.size(); thread++) {
+            ThreadPoolStats single = stats(thread);
+            total.jobs_run += single.jobs_run;
+            total.steals += single.steals;
+            total.idle_time += single.idle_time;
+        }
+        return total;
+    }
+
+    void reset_stats() {
+        for (auto& slot : slots_) {
+            slot->jobs_run         = 0;
+            slot->steals           = 0;
+            slot->idle_nanoseconds = 0;
+        }
+    }
+
+    private:
+    // queue and statistics of one thread. slot 0 is shared by all threads outside of the pool
+    struct Slot {
+        std::mutex                mutex {};
+        std::deque<Job>           jobs {};
+        std::atomic<ID>           jobs_run {0};
+        std::atomic<ID>           steals {0};
+        std::atomic<std::int64_t> idle_nanoseconds {0};
+    };
+
+    ID                                 thread_count_ = 1;
+    std::vector<std::unique_ptr<Slot>> slots_ {};
+    std::vector<std::thread>           workers_ {};
+    std::atomic<ID>                    pending_ {0};
+    std::atomic<bool>                  started_ {false};
+    std::mutex                         start_mutex_ {};
+    std::mutex                         sleep_mutex_ {};
+    std::condition_variable            sleep_condition_ {};
+    bool                               stopping_ = false;
+
+    // slot of the calling thread within this pool
+    ID current_slot() const {
+        return current_pool() == this ? current_index() : 0;
+    }
+
+    static const ThreadPool*& current_pool() {
+        thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static ID& current_index() {
+        thread_local ID index = 0;
+        return index;
+    }
+
+    bool pop_back(ID index, Job& job) {
+        Slot&                       slot = *slots_[index];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.jobs.empty())
+            return false;
+        job = std::move(slot.jobs.back());
+        slot.jobs.pop_back();
+        pending_--;
+        return true;
+    }
+
+    bool steal_front(ID index, Job& job) {
+        Slot&                       slot = *slots_[index];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.jobs.empty())
+            return false;
+        job = std::move(slot.jobs.front());
+        slot.jobs.pop_front();
+        pending_--;
+        return true;
+    }
+
+    // the calling thread takes part in the work as well, so one worker less is required
+    void start() {
+        if (started_)
+            return;
+        std::lock_guard<std::mutex> lock(start_mutex_);
+        if (started_)
+            return;
+        stopping_ = false;
+        for (ID index = 1; index < thread_count_; index++) {
+            workers_.emplace_back([this, index] { work(index); });
+        }
+        started_ = true;
+    }
+
+    // lets the workers finish all queued jobs and joins them
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_condition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+        started_ = false;
+    }
+
+    void work(ID index) {
+        current_pool()  = this;
+        current_index() = index;
+
+        while (true) {
+            if (run_pending())
+                continue;
+
+            auto idle_start = std::chrono::steady_clock::now();
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                sleep_condition_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+                if (stopping_ && pending_ == 0)
+                    return;
+            }
+            auto idle_end = std::chrono::steady_clock::now();
+            slots_[index]->idle_nanoseconds +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(idle_end - idle_start).count();
+        }
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_THREAD_POOL_H
+
+
+// end --- thread_pool.h --- 
+
+
+
+// begin --- view.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_VIEW_H
+#define ECS_VIEW_H
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Query over the active entities owning all given components, yielding the components.
+ *
+ * Iterating a view yields tuples of the entity id and references to its components, which can be
+ * unpacked using structured bindings. The components are taken from the pools directly, so unlike
+ * Entity::get no further lookups are required. Without, Optional and Changed terms may be used
+ * as well. Components yielded as mutable references are stamped with the tick of the view.
+ *
+ * @tparam Terms The component types each entity must own and further terms.
+ */
+template<typename... Terms>
+struct View {
+    using value_type = TermValues<Terms...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = View::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const View* view, ID position)
+            : m_view(view), m_position(position) {
+            advance_to_next_valid();
+        }
+
+        reference operator*() const {
+            ID id = (*m_view->ids)[m_position];
+            return term_values<Terms...>((*m_view->entities)[id].id(),
+                                         m_view->pools,
+                                         m_view->tick,
+                                         std::index_sequence_for<Terms...> {});
+        }
+
+        iterator& operator++() {
+            ++m_position;
+            advance_to_next_valid();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
+        }
+
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
+        }
+
+        private:
+        const View* m_view;
+        ID          m_position;
+
+        // skips inactive entities and those not matching the terms
+        void advance_to_next_valid() {
+            while (m_position < m_view->ids->size()) {
+                ID            id     = (*m_view->ids)[m_position];
+                const Entity& entity = (*m_view->entities)[id];
+                if (entity.active() && entity.matches(m_view->mask, m_view->excluded)
+                    && (unfiltered<Terms...>
+                        || term_accepts<Terms...>(id,
+                                                  m_view->pools,
+                                                  m_view->since,
+                                                  std::index_sequence_for<Terms...> {})))
+                    return;
+                ++m_position;
+            }
+        }
+    };
+
+    // candidate entities, usually those of the smallest pool among the required types
+    std::vector<ID>*     ids;
+    std::vector<Entity>* entities;
+    TermPools<Terms...>  pools;
+    // the tick stamped into mutably accessed components and the one Changed terms compare to
+    Tick                 tick;
+    Tick                 since;
+    Signature            mask     = required_of<Terms...>();
+    Signature            excluded = excluded_of<Terms...>();
+
+    iterator begin() const {
+        return iterator {this, 0};
+    }
+
+    iterator end() const {
+        return iterator {this, ids->size()};
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_VIEW_H
+
+
+// end --- view.h --- 
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ecs {
@@ -972,18 +2938,47 @@ namespace ecs {
  * to create entities, add/remove components, and process systems.
  */
 struct ECS : public ECSBase {
-    std::unordered_map<Hash, ComponentEntityList>                     component_entity_lists {};
     std::vector<Entity>                                               entities {};
-    CompactVector<ID>                                                 active_entities {};
+    std::vector<ID>                                                   free_entities {};
+    IndexedVector                                                     active_entities {};
+    // list handed out by queries over component types without a pool
+    std::vector<ID>                                                   no_entities {};
 
     RecyclingVector<System::Ptr>                                      systems {nullptr};
-    std::unordered_map<Hash, RecyclingVector<EventListenerBase::Ptr>> event_listener {};
+    SystemSchedule                                                    system_schedule {};
+    bool                                                              schedule_outdated = true;
+    std::vector<RecyclingVector<EventListenerBase::Ptr>>              event_listener {};
+
+    ThreadPool                                                        thread_pool {};
+
+    // registered queries indexed by their type hash, and the ones affected by each component type
+    std::vector<std::unique_ptr<QueryBase>>                           queries {};
+    std::vector<std::vector<QueryBase*>>                              component_queries {};
+    std::mutex                                                        query_mutex {};
+
+    // owning groups indexed by their type hash, and the group owning each component type
+    std::vector<std::unique_ptr<GroupBase>>                           groups {};
+    std::vector<GroupBase*>                                           owning_groups {};
+
+    // all observers, and the ones recording assignments and removals of each component type
+    std::vector<std::unique_ptr<Observer>>                            observers {};
+    std::vector<std::vector<Observer*>>                               added_observers {};
+    std::vector<std::vector<Observer*>>                               removed_observers {};
+
+    // one command buffer per recording thread
+    std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer>> command_buffers {};
+    std::mutex                                                          command_mutex {};
+    // distinguishes ecs instances which happen to share an address
+    const ID serial = next_serial();
 
     // Grant Entity access to private members.
     friend Entity;
     friend ComponentEntityList;
 
-    ECS() = default;
+    // thread_count is the amount of threads used for parallel work including the calling one.
+    // zero uses all hardware threads
+    explicit ECS(ID thread_count = 0)
+        : thread_pool(thread_count) {}
 
     // Delete copy constructor and copy assignment operator
     ECS(const ECS&) = delete;
@@ -997,12 +2992,119 @@ struct ECS : public ECSBase {
         destroy_all_systems();
     }
 
-    public:
-    EntityID spawn(bool active = false);
+    public:
+    // the command buffer of the calling thread
+    CommandBuffer& commands();
+    // applies and clears the commands recorded by all threads. must not run concurrently to
+    // iterations or other structural changes
+    void           flush_commands();
+
+    EntityID spawn(bool active = false);
+
+    /**
+     * @brief Spawns multiple entities owning the same component types at once.
+     *
+     * Entity slots and component storage are reserved up front and the components are constructed
+     * in place by their default constructor. As all components of an entity are created together,
+     * no other_component_added notifications are sent.
+     *
+     * @tparam Types The component types each entity receives.
+     * @param count Amount of entities to spawn.
+     * @param active Whether the entities are activated once they are set up.
+     * @param init Called as init(entity, components...) for each entity once it owns all of its
+     *             components and before activating it. It may assign further components but must
+     *             neither destroy the entity nor remove or reassign any of Types.
+     * @return The ids of the spawned entities.
+     */
+    template<typename... Types, typename F>
+    std::vector<EntityID> spawn_batch(ID count, bool active, F&& init);
+    template<typename... Types>
+    std::vector<EntityID> spawn_batch(ID count, bool active = false);
+
+    // reserves storage for the given amount of components of type T so that assigning up to that
+    // many components does not allocate
+    template<typename T>
+    void reserve(ID capacity) {
+        pool<T>()->reserve(capacity);
+    }
+
+    // marks T as a frame-temporary component type. all components of such a type are removed at
+    // the end of each process() while their storage is kept, so creating them during the next
+    // frame does not allocate again
+    template<typename T>
+    void set_transient(bool transient = true) {
+        pool<T>()->transient = transient;
+    }
+
+    // removes the components of all transient types
+    void clear_transient();
+
+    /**
+     * @brief Sorts the components of type T and with them the iteration order of queries over T.
+     *
+     * If T is owned by a group, the members of the group and the remaining components are sorted
+     * separately and the other pools of the group follow the new order.
+     *
+     * @param compare Strict weak ordering called as compare(const T&, const T&).
+     * @param mode SORT_INSERTION is linear for nearly sorted pools.
+     */
+    template<typename T, typename Compare>
+    void sort(Compare compare, SortMode mode = SORT_FULL);
+
+    // arranges the components of type T in the order of the components of type U. components of
+    // entities without U end up behind all others. throws std::logic_error if T is owned by a group
+    template<typename T, typename U>
+    void sort_as();
+
+    // the values of the N-th field of all components of the columnar type T. the value at index i
+    // belongs to the entity pool<T>()->entities[i]. like queries, this creates no pool so that
+    // concurrently running systems may call it, the column is empty if there is none yet. unless
+    // T is const, all components of the type are marked as changed, see Changed
+    template<typename T, ID N>
+    auto column() {
+        using Type    = std::remove_const_t<T>;
+        using Column  = std::tuple_element_t<N, typename ComponentPool<Type>::Columns>;
+        using Element = std::conditional_t<std::is_const_v<T>,
+                                           const typename Column::value_type,
+                                           typename Column::value_type>;
+
+        auto pool = static_cast<ComponentPool<Type>*>(find_pool(Type::hash()));
+        if (pool == nullptr)
+            return ColumnSpan<Element> {};
+        if constexpr (!std::is_const_v<T>) {
+            pool->touch(0, pool->size(), change_tick);
+        }
+        Column& column = pool->template column<N>();
+        return ColumnSpan<Element> {column.data(), column.size()};
+    }
+
+    // removes the component of type T from all entities owning one, including inactive ones
+    template<typename T>
+    void remove_all();
+    // removes the component of type T from the given entities with a single pass over its pool
+    template<typename T>
+    void remove_all(const std::vector<EntityID>& ids);
+    template<typename T, typename... RTypes>
+    void remove_all(EntitySubSet<RTypes...> subset);
+
+    // assigns a component of type T constructed from args to each of the given entities. existing
+    // components of that type are replaced, just like assign does
+    template<typename T, typename... Args>
+    void assign_all(const std::vector<EntityID>& ids, const Args&... args);
+    template<typename T, typename... RTypes, typename... Args>
+    void assign_all(EntitySubSet<RTypes...> subset, const Args&... args);
+
     void     destroy_entity(EntityID id) override;
     void     destroy_all_entities();
     void     destroy_all_systems();
 
+    // checks if the id refers to an entity which has not been destroyed since
+    bool valid(EntityID id) const {
+        return id.id < entities.size()
+               && entities[id.id].entity_id.id == id.id
+               && entities[id.id].entity_id.generation == id.generation;
+    }
+
     // operators to get an entity from an id
     Entity& operator[](ID id) {
         return entities[id];
@@ -1021,26 +3123,203 @@ struct ECS : public ECSBase {
     void entity_activated(EntityID id) override;
     void entity_deactivated(EntityID id) override;
 
+    static ID next_serial() {
+        static std::atomic<ID> counter {0};
+        return counter++;
+    }
+
+    // returns the slot of a destroyed entity or appends a new one
+    ID acquire_slot();
+
+    // removes all components of the given pool from their entities, keeping its storage
+    void clear_pool(Hash hash);
+
+    // creates an observer and lists it for the given component type
+    Observer& add_observer(std::vector<std::vector<Observer*>>& table, Hash hash);
+
     // functions to manage the lists
-    void add_to_component_list(ID entity);
-    void remove_from_component_list(ID entity);
-    void add_to_component_list(ID entity, Hash hash);
-    void remove_from_component_list(ID entity, Hash hash);
     void add_to_active_entities(ID entity);
     void remove_from_active_entities(ID entity);
 
+    // splits the first pool into runs of matching entities whose components are adjacent in all
+    // pools and passes them to func. the runs of the types which are not const are marked as
+    // changed
+    template<typename... Types, typename... Pools, std::size_t... I, typename F>
+    void chunk_runs(std::tuple<Pools*...>& pools, std::index_sequence<I...>, F& func) {
+        static const Signature mask     = signature_of<typename Pools::Component...>();
+        auto                   matching = [&](ID entity) {
+            return entities[entity].active() && entities[entity].matches(mask);
+        };
+
+        auto& driver = *std::get<0>(pools);
+        for (ID begin = 0; begin < driver.size();) {
+            ID first = driver.entities[begin];
+            if (!matching(first)) {
+                begin++;
+                continue;
+            }
+
+            ID   start[] {std::get<I>(pools)->index_of(first)...};
+            auto adjacent = [&](ID entity, ID offset) {
+                return ((start[I] + offset < std::get<I>(pools)->size()
+                         && std::get<I>(pools)->entities[start[I] + offset] == entity)
+                        && ...);
+            };
+
+            ID end = begin + 1;
+            while (end < driver.size() && matching(driver.entities[end])
+                   && adjacent(driver.entities[end], end - begin)) {
+                end++;
+            }
+
+            ((std::is_const_v<Types>
+                  ? void()
+                  : std::get<I>(pools)->touch(start[I], start[I] + end - begin, change_tick)),
+             ...);
+            func(static_cast<Types*>(&std::get<I>(pools)->components[start[I]])..., end - begin);
+            begin = end;
+        }
+    }
+
+    // returns the entity list of the pool with the fewest components among the required types of
+    // the given terms. every entity matching a query over these terms is contained in it, so it is
+    // the cheapest one to iterate. no pools are created here so that concurrently running systems
+    // may query freely.
+    template<typename... Terms>
+    inline std::vector<ID>* smallest_list() {
+        static_assert((Term<Terms>::required || ...), "a query requires at least one component type");
+
+        ComponentPoolBase* smallest = nullptr;
+        bool               missing  = false;
+        auto               consider = [&](ComponentPoolBase* pool) {
+            // a missing pool means that no entity can match
+            if (pool == nullptr) {
+                missing = true;
+            } else if (smallest == nullptr || pool->size() < smallest->size()) {
+                smallest = pool;
+            }
+        };
+        ((Term<Terms>::required ? consider(Term<Terms>::find(this)) : void()), ...);
+
+        return missing || smallest == nullptr ? &no_entities : &smallest->entities.elements;
+    }
+
     public:
     template<typename K, typename... R>
     inline EntitySubSet<K, R...> each() {
-        auto  hash = K::hash();
-        auto* ids  = &component_entity_lists[hash].elements;
-        return EntitySubSet<K, R...> {ids, &entities};
+        return EntitySubSet<K, R...> {smallest_list<K, R...>(), &entities};
+    }
+
+    // iterates the active entities owning all given components, yielding (id, components...).
+    // Changed terms only match components written after the given tick, usually the one at which
+    // the calling system last ran, see System::last_run
+    template<typename K, typename... R>
+    inline View<K, R...> view(Tick since = 0) {
+        return View<K, R...> {smallest_list<K, R...>(),
+                              &entities,
+                              find_term_pools<K, R...>(this),
+                              change_tick,
+                              since};
+    }
+
+    /**
+     * @brief Returns the persistent query over the active entities owning all given components.
+     *
+     * The query is registered by the first call and kept up to date from then on, so iterating it
+     * requires no filtering. Registering a query walks the matching entities once.
+     */
+    template<typename K, typename... R>
+    Query<K, R...>& query();
+
+    /**
+     * @brief Returns the owning group of the given component types.
+     *
+     * The group is registered by the first call. From then on, the components of all entities
+     * owning every type are kept at the front of the pools in the same order. A component type can
+     * be owned by one group only, registering a second group for it throws std::logic_error.
+     * Groups should be registered before systems run concurrently.
+     */
+    template<typename K, typename... R>
+    Group<K, R...>& group();
+
+    /**
+     * @brief Returns a new observer recording the entities which are assigned a component of type T.
+     *
+     * Observers live as long as the ecs and should be registered before systems run concurrently.
+     * The observer recording removals also records the components of destroyed entities.
+     */
+    template<typename T>
+    Observer& observe_added();
+    template<typename T>
+    Observer& observe_removed();
+
+    // returns a new observer recording the entities which start matching the query over the given
+    // terms, see query(). entities matching already when the observer is registered are skipped
+    template<typename K, typename... R>
+    Observer& observe_entered();
+
+    // iterates all active entities
+    inline EntitySubSet<> each_active() {
+        return EntitySubSet<> {&active_entities.elements, &entities};
+    }
+
+    /**
+     * @brief Calls func(entity) for each active entity with all the given components in parallel.
+     *
+     * The matching entities are split into chunks of grain_size entities which are processed by
+     * the thread pool. Each entity is visited by exactly one thread, so func may freely modify the
+     * components of the entity it is given. It must not touch other entities nor add or remove
+     * components or entities while the iteration is running.
+     *
+     * @param func The function to call for each matching entity.
+     * @param grain_size Amount of entities per chunk. Zero picks a few chunks per thread.
+     */
+    template<typename K, typename... R, typename F>
+    inline void par_each(F&& func, ID grain_size = 0) {
+        static_assert(unfiltered<K, R...>, "Changed terms are only supported by views");
+
+        const std::vector<ID>& ids      = *smallest_list<K, R...>();
+        const Signature        mask     = required_of<K, R...>();
+        const Signature        excluded = excluded_of<K, R...>();
+
+        thread_pool.parallel_for(0, ids.size(), grain_size, [&](ID begin, ID end) {
+            for (ID i = begin; i < end; i++) {
+                Entity& entity = entities[ids[i]];
+                if (entity.active() && entity.matches(mask, excluded)) {
+                    func(entity);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Calls func(k, r..., count) for contiguous runs of active entities owning all given
+     * components.
+     *
+     * The pointers point to count consecutive components within the pools of the respective types,
+     * so the function can process them with plain, vectorisable loops. A run ends as soon as the
+     * next entity does not match or its components are not adjacent within every pool. Pools which
+     * store their components in the same order yield runs spanning the entire pool. The runs of
+     * component types which are not const are marked as changed, see Changed.
+     *
+     * @param func The function to call for each run.
+     */
+    template<typename K, typename... R, typename F>
+    inline void for_each_chunk(F&& func) {
+        auto pools = find_term_pools<K, R...>(this);
+        // a missing pool means that no entity can match
+        if (std::apply([](auto*... pool) { return ((pool == nullptr) || ...); }, pools))
+            return;
+        chunk_runs<K, R...>(pools, std::index_sequence_for<K, R...> {}, func);
     }
 
     template<typename K, typename... R>
     inline ID first() {
-        for (ID id : component_entity_lists[K::hash()].entities) {
-            if (entities[id].has<K, R...>()) {
+        static_assert(unfiltered<K, R...>, "Changed terms are only supported by views");
+        static const Signature mask     = required_of<K, R...>();
+        static const Signature excluded = excluded_of<K, R...>();
+        for (ID id : *smallest_list<K, R...>()) {
+            if (entities[id].active() && entities[id].matches(mask, excluded)) {
                 return id;
             }
         }
@@ -1049,10 +3328,13 @@ struct ECS : public ECSBase {
 
     template<typename Event>
     inline void emit_event(const Event& event) {
-        Hash hash = get_type_hash<Event>();
-        if (event_listener.find(hash) == event_listener.end())
+        Hash hash = get_type_hash<Event, EventListenerBase>();
+        if (hash >= event_listener.size())
             return;
         for (auto listener : event_listener[hash]) {
+            // skip slots of destroyed listeners
+            if (!listener)
+                continue;
             auto l = reinterpret_cast<EventListener<Event>*>(listener.get());
             l->receive(this, event);
         }
@@ -1062,13 +3344,24 @@ struct ECS : public ECSBase {
     SystemID create_system(Args&&... args) {
         std::shared_ptr<T> system = std::make_shared<T>(std::forward<Args>(args)...);
         ID pos = systems.push_back(system);
+        schedule_outdated = true;
         return SystemID{pos};
     }
     void destroy_system(SystemID id) override {
-        if (id >= systems.size())
+        if (id >= systems.size() || !systems[id])
             return;
         systems[id]->destroyed();
         systems.remove_at(id);
+        schedule_outdated = true;
+    }
+
+    // the order in which process() runs the systems, rebuilt whenever systems change
+    const SystemSchedule& schedule() {
+        if (schedule_outdated) {
+            system_schedule.build(systems);
+            schedule_outdated = false;
+        }
+        return system_schedule;
     }
 
     template<typename T, typename... Args>
@@ -1076,14 +3369,14 @@ struct ECS : public ECSBase {
         std::shared_ptr<T> listener = std::make_shared<T>(std::forward<Args>(args)...);
         auto hash = listener->hash;
 
-        if (event_listener.find(hash) == event_listener.end()) {
-            event_listener[hash] = {nullptr};
+        if (hash >= event_listener.size()) {
+            event_listener.resize(hash + 1, RecyclingVector<EventListenerBase::Ptr> {nullptr});
         }
         ID pos = event_listener[hash].push_back(listener);
         return EventListenerID{pos, hash};
     }
     void destroy_listener(EventListenerID id) override {
-        event_listener[id.operator Hash()].remove_at((ID)id);
+        event_listener[id.hash].remove_at(id.id);
     }
 
     void                 process(double delta);
@@ -1116,12 +3409,14 @@ struct ECS : public ECSBase {
         }
         os << std::endl;
 
-        os << "Component Entity List: " << std::endl;
+        os << "Component Pools: " << std::endl;
         os << "-----------------------" << std::endl;
-        for (const auto& pair : ecs1.component_entity_lists) {
-            os << "Component Hash: " << std::setw(20) << pair.first.hash_code() << std::endl;
+        for (Hash hash = 0; hash < ecs1.component_pools.size(); hash++) {
+            if (!ecs1.component_pools[hash])
+                continue;
+            os << "Component Hash: " << std::setw(20) << hash << std::endl;
             os << "Entities: " << std::endl;
-            for (const auto& id : pair.second) {
+            for (const auto& id : ecs1.component_pools[hash]->entities) {
                 os << std::setw(10);
                 if (id != INVALID_ID) {
                     os << id << " | Active: " << (ecs1.entities[id].active() ? "true" : "false");
@@ -1142,19 +3437,256 @@ struct ECS : public ECSBase {
 
 
 
+inline ecs::ID ecs::ECS::acquire_slot() {
+    // reuse the slot of a destroyed entity if possible
+    ID slot;
+    if (!free_entities.empty()) {
+        slot = free_entities.back();
+        free_entities.pop_back();
+    } else {
+        slot = entities.size();
+        entities.emplace_back(Entity{this});
+    }
+
+    Entity& entity   = entities[slot];
+    entity.entity_id = EntityID{slot, entity.entity_id.generation};
+    return slot;
+}
+
+template<typename T, typename Compare>
+inline void ecs::ECS::sort(Compare compare, SortMode mode) {
+    Hash hash = T::hash();
+    auto pool = static_cast<ComponentPool<T>*>(find_pool(hash));
+    if (pool == nullptr)
+        return;
+
+    GroupBase* group = hash < owning_groups.size() ? owning_groups[hash] : nullptr;
+    if (group == nullptr) {
+        pool->sort(0, pool->size(), compare, mode);
+        return;
+    }
+
+    pool->sort(0, group->size, compare, mode);
+    pool->sort(group->size, pool->size(), compare, mode);
+    for (ComponentPoolBase* other : group->pools) {
+        if (other == pool)
+            continue;
+        for (ID index = 0; index < group->size; index++) {
+            other->swap_at(other->index_of(pool->entities[index]), index);
+        }
+    }
+}
+
+template<typename T, typename U>
+inline void ecs::ECS::sort_as() {
+    Hash       hash      = T::hash();
+    auto       pool      = find_pool(hash);
+    const auto reference = find_pool(U::hash());
+    // moving the components would break the arrangement of the group
+    if (hash < owning_groups.size() && owning_groups[hash] != nullptr) {
+        throw std::logic_error("ecs: sort_as cannot rearrange a component type owned by a group");
+    }
+    if (pool == nullptr || reference == nullptr)
+        return;
+
+    ID position = 0;
+    for (ID entity : reference->entities) {
+        ID index = pool->index_of(entity);
+        if (index != INVALID_ID) {
+            pool->swap_at(index, position++);
+        }
+    }
+}
+
+template<typename T>
+inline void ecs::ECS::remove_all() {
+    clear_pool(T::hash());
+}
+
+inline void ecs::ECS::clear_pool(Hash hash) {
+    ComponentPoolBase* pool = find_pool(hash);
+    if (pool == nullptr)
+        return;
+
+    // every member of an owning group loses this component, so the group simply becomes empty
+    if (hash < owning_groups.size() && owning_groups[hash]) {
+        owning_groups[hash]->size = 0;
+    }
+
+    bool notify = hooked[HOOK_COMPONENT_REMOVED].test(hash);
+    for (ID index = 0; index < pool->size(); index++) {
+        Entity& entity = entities[pool->entities[index]];
+        if (notify) {
+            pool->get_base(entity.entity_id)->component_removed();
+        }
+        entity.signature.reset(hash);
+        component_removed(hash, entity.entity_id);
+    }
+    pool->clear();
+}
+
+inline void ecs::ECS::clear_transient() {
+    for (Hash hash = 0; hash < component_pools.size(); hash++) {
+        if (component_pools[hash] && component_pools[hash]->transient) {
+            clear_pool(hash);
+        }
+    }
+}
+
+template<typename T>
+inline void ecs::ECS::remove_all(const std::vector<EntityID>& ids) {
+    Hash hash = T::hash();
+    auto pool = static_cast<ComponentPool<T>*>(find_pool(hash));
+    if (pool == nullptr)
+        return;
+
+    ID removed = 0;
+    for (EntityID id : ids) {
+        if (!valid(id) || !entities[id].signature.test(hash))
+            continue;
+        if constexpr (T::overrides(HOOK_COMPONENT_REMOVED)) {
+            pool->get(id)->component_removed();
+        }
+        entities[id].signature.reset(hash);
+        component_removed(hash, id);
+        removed++;
+    }
+
+    // drop the components of all entities which lost their bit at once
+    if (removed > 0) {
+        pool->retain([&](ID entity) { return entities[entity].signature.test(hash); });
+    }
+}
+
+template<typename T, typename... RTypes>
+inline void ecs::ECS::remove_all(EntitySubSet<RTypes...> subset) {
+    // collect the entities first as removing the components would invalidate the iteration
+    std::vector<EntityID> ids;
+    for (Entity& entity : subset) {
+        ids.push_back(entity.entity_id);
+    }
+    remove_all<T>(ids);
+}
+
+template<typename T, typename... Args>
+inline void ecs::ECS::assign_all(const std::vector<EntityID>& ids, const Args&... args) {
+    remove_all<T>(ids);
+
+    Hash              hash = T::hash();
+    ComponentPool<T>* pool = this->pool<T>();
+    pool->reserve(pool->size() + ids.size());
+
+    for (EntityID id : ids) {
+        // skips stale ids as well as ids listed more than once
+        if (!valid(id) || entities[id].signature.test(hash))
+            continue;
+
+        Entity& entity         = entities[id];
+        T&      component      = pool->emplace(id, args...);
+        component.ecs          = this;
+        component.component_id = ComponentID{id, hash};
+        pool->ticks.back()     = change_tick;
+        entity.signature.set(hash);
+
+        const Signature& notified = hooked[HOOK_OTHER_COMPONENT_ADDED];
+        entity.for_each_component(notified, [&](Hash other, ComponentBase* comp) {
+            if (other != hash) {
+                comp->other_component_added(hash);
+            }
+        });
+        if constexpr (T::overrides(HOOK_OTHER_COMPONENT_ADDED)) {
+            entity.for_each_component([&](Hash other, ComponentBase*) {
+                if (other != hash) {
+                    component.other_component_added(other);
+                }
+            });
+        }
+
+        if constexpr (T::overrides(HOOK_ENTITY_ACTIVATED)) {
+            if (entity.active()) {
+                component.entity_activated();
+            }
+        }
+
+        // last, as groups may move the component within its pool
+        component_added(hash, id);
+    }
+}
+
+template<typename T, typename... RTypes, typename... Args>
+inline void ecs::ECS::assign_all(EntitySubSet<RTypes...> subset, const Args&... args) {
+    std::vector<EntityID> ids;
+    for (Entity& entity : subset) {
+        ids.push_back(entity.entity_id);
+    }
+    assign_all<T>(ids, args...);
+}
+
 inline ecs::EntityID ecs::ECS::spawn(bool active) {
+    Entity& entity = entities[acquire_slot()];
+
+    if (active) {
+        entity.activate();
+    }
+
+    return entity.entity_id;
+}
 
-    entities.emplace_back(Entity{this});
-    entities.back().entity_id = EntityID{entities.size() - 1};
+template<typename... Types, typename F>
+inline std::vector<ecs::EntityID> ecs::ECS::spawn_batch(ID count, bool active, F&& init) {
+    std::vector<EntityID> ids;
+    ids.reserve(count);
+
+    // reserve everything up front so the batch causes at most one reallocation per container
+    ID reused = std::min<ID>(count, free_entities.size());
+    entities.reserve(entities.size() + count - reused);
+    for (ID i = 0; i < count; i++) {
+        ids.push_back(entities[acquire_slot()].entity_id);
+    }
+
+    std::tuple<ComponentPool<Types>*...> pools {pool<Types>()...};
+    std::apply([&](auto*... pool) { (pool->reserve(pool->size() + count), ...); }, pools);
+
+    static const Signature mask = signature_of<Types...>();
+    for (EntityID id : ids) {
+        Entity& entity = entities[id];
+        auto construct = [&](auto* pool) {
+            auto& component        = pool->emplace(id);
+            component.ecs          = this;
+            component.component_id = ComponentID{id, pool->entities.comp_hash_};
+            pool->ticks.back()     = change_tick;
+        };
+        std::apply([&](auto*... pool) { (construct(pool), ...); }, pools);
+        entity.signature |= mask;
+        (component_added(Types::hash(), id), ...);
+        // joining a group may have moved the components, so look them up again for init
+        std::apply([&](auto*... pool) { init(entity, *pool->get(id.id)...); }, pools);
+    }
 
     if (active) {
-        entities.back().activate();
+        active_entities.reserve(active_entities.size() + count);
+        for (EntityID id : ids) {
+            entities[id].m_active = true;
+            entity_activated(id);
+            ((Types::overrides(HOOK_ENTITY_ACTIVATED)
+                  ? std::get<ComponentPool<Types>*>(pools)->get(id)->entity_activated()
+                  : void()),
+             ...);
+        }
     }
+    return ids;
+}
 
-    return entities.back().entity_id;
+template<typename... Types>
+inline std::vector<ecs::EntityID> ecs::ECS::spawn_batch(ID count, bool active) {
+    return spawn_batch<Types...>(count, active, [](Entity&, Types&...) {});
 }
 
 inline void ecs::ECS::destroy_entity(ecs::EntityID id) {
+    // ignore stale ids of entities which have already been destroyed
+    if (!valid(id))
+        return;
+
     // get the entity at the given id
     auto entity = &entities[id];
 
@@ -1164,34 +3696,164 @@ inline void ecs::ECS::destroy_entity(ecs::EntityID id) {
     // destroy the components
     entity->remove_all_components();
 
-    // set the entity's id to INVALID_ID and the pointer to nullptr
-    entity->entity_id = EntityID{INVALID_ID};
+    // set the entity's id to INVALID_ID and advance the generation so that existing ids of this
+    // entity become stale, then allow the slot to be reused
+    entity->entity_id = EntityID{INVALID_ID, id.generation + 1};
+    free_entities.push_back(id);
 }
 
 inline void ecs::ECS::destroy_all_entities() {
     for (Entity& entity : entities) {
-        destroy_entity(entity.entity_id);
+        if (entity.valid()) {
+            destroy_entity(entity.entity_id);
+        }
     }
-    entities.clear();
+    // the slots keep their generations so ids from before stay stale. all slots are free now,
+    // listed so that the lowest ones are reused first
+    free_entities.resize(entities.size());
+    std::iota(free_entities.rbegin(), free_entities.rend(), ID {0});
 }
 
 inline void ecs::ECS::destroy_all_systems() {
     for (auto sys : systems) {
-        sys->destroyed();
+        if (sys) {
+            sys->destroyed();
+        }
     }
     systems.clear();
+    schedule_outdated = true;
+}
+
+template<typename K, typename... R>
+inline ecs::Query<K, R...>& ecs::ECS::query() {
+    Hash                        hash = get_type_hash<Query<K, R...>, QueryBase>();
+    std::lock_guard<std::mutex> lock(query_mutex);
+    if (hash >= queries.size()) {
+        queries.resize(hash + 1);
+    }
+
+    auto& ptr = queries[hash];
+    if (!ptr) {
+        auto query = std::make_unique<Query<K, R...>>(this, &entities);
+        for (ID id : *smallest_list<K, R...>()) {
+            query->update(entities[id]);
+        }
+        // the query depends on both the required and the excluded component types
+        Signature dependencies = query->mask | query->excluded;
+        for (Hash component = 0; component < ECS_MAX_COMPONENTS; component++) {
+            if (!dependencies.test(component))
+                continue;
+            if (component >= component_queries.size()) {
+                component_queries.resize(component + 1);
+            }
+            component_queries[component].push_back(query.get());
+        }
+        ptr = std::move(query);
+    }
+    return *static_cast<Query<K, R...>*>(ptr.get());
+}
+
+template<typename K, typename... R>
+inline ecs::Group<K, R...>& ecs::ECS::group() {
+    Hash hash = get_type_hash<Group<K, R...>, GroupBase>();
+    if (hash >= groups.size()) {
+        groups.resize(hash + 1);
+    }
+
+    auto& ptr = groups[hash];
+    if (!ptr) {
+        // each pool can only be arranged by a single group. all types are checked before any of
+        // them is claimed so a rejected group leaves no trace
+        for (Hash component : {K::hash(), R::hash()...}) {
+            if (component < owning_groups.size() && owning_groups[component] != nullptr) {
+                throw std::logic_error("ecs: a component type is already owned by another group");
+            }
+        }
+        auto group =
+            std::make_unique<Group<K, R...>>(&entities, &change_tick, pool<K>(), pool<R>()...);
+        for (Hash component : {K::hash(), R::hash()...}) {
+            if (component >= owning_groups.size()) {
+                owning_groups.resize(component + 1, nullptr);
+            }
+            owning_groups[component] = group.get();
+        }
+        for (ID id : *smallest_list<K, R...>()) {
+            if (entities[id].matches(group->mask)) {
+                group->join(id);
+            }
+        }
+        ptr = std::move(group);
+    }
+    return *static_cast<Group<K, R...>*>(ptr.get());
+}
+
+template<typename T>
+inline ecs::Observer& ecs::ECS::observe_added() {
+    return add_observer(added_observers, T::hash());
+}
+
+template<typename T>
+inline ecs::Observer& ecs::ECS::observe_removed() {
+    return add_observer(removed_observers, T::hash());
+}
+
+template<typename K, typename... R>
+inline ecs::Observer& ecs::ECS::observe_entered() {
+    Query<K, R...>& query = this->query<K, R...>();
+    observers.push_back(std::make_unique<Observer>());
+    query.entered.push_back(observers.back().get());
+    return *observers.back();
+}
+
+inline ecs::Observer& ecs::ECS::add_observer(std::vector<std::vector<Observer*>>& table, Hash hash) {
+    if (hash >= table.size()) {
+        table.resize(hash + 1);
+    }
+    observers.push_back(std::make_unique<Observer>());
+    table[hash].push_back(observers.back().get());
+    return *observers.back();
 }
 
+// the pools already contain the components of inactive entities, so only the queries, groups and
+// observers need to be updated when components are added or removed
 inline void ecs::ECS::component_removed(ecs::Hash hash, EntityID id) {
-    if (entities[id].active()) {
-        remove_from_component_list(id, hash);
+    if (hash < removed_observers.size()) {
+        for (Observer* observer : removed_observers[hash]) {
+            observer->record(id);
+        }
+    }
+    if (hash < owning_groups.size() && owning_groups[hash] && owning_groups[hash]->contains(id.id)) {
+        owning_groups[hash]->leave(id.id);
+    }
+    if (hash < component_queries.size()) {
+        // the component is still part of the signature at this point
+        Signature remaining = entities[id.id].signature;
+        remaining.reset(hash);
+        for (QueryBase* query : component_queries[hash]) {
+            query->update(id, entities[id.id].active() && query->accepts(remaining));
+        }
     }
 }
+
 inline void ecs::ECS::component_added(ecs::Hash hash, EntityID id) {
-    if (entities[id].active()) {
-        add_to_component_list(id, hash);
+    if (hash < added_observers.size()) {
+        for (Observer* observer : added_observers[hash]) {
+            observer->record(id);
+        }
+    }
+    if (hash < owning_groups.size() && owning_groups[hash]) {
+        GroupBase* group = owning_groups[hash];
+        if (entities[id.id].matches(group->mask) && !group->contains(id.id)) {
+            group->join(id.id);
+        }
+    }
+    if (hash < component_queries.size()) {
+        for (QueryBase* query : component_queries[hash]) {
+            query->update(entities[id.id]);
+        }
     }
 }
+
 inline void ecs::ECS::entity_activated(ecs::EntityID entity_id) {
     if (entity_id == INVALID_ID || entity_id >= entities.size())
         return;
@@ -1201,7 +3863,11 @@ inline void ecs::ECS::entity_activated(ecs::EntityID entity_id) {
         return;
 
     add_to_active_entities(entity_id);
-    add_to_component_list(entity_id);
+    for (auto& query : queries) {
+        if (query) {
+            query->update(entities[entity_id]);
+        }
+    }
 }
 
 inline void ecs::ECS::entity_deactivated(ecs::EntityID entity_id) {
@@ -1213,31 +3879,11 @@ inline void ecs::ECS::entity_deactivated(ecs::EntityID entity_id) {
         return;
     // remove from active entities
     remove_from_active_entities(entity_id);
-    remove_from_component_list(entity_id);
-}
-inline void ecs::ECS::add_to_component_list(ID id) {
-    auto entity = &entities[id];
-    for (auto& [hash, component] : entity->components) {
-        add_to_component_list(id, hash);
-    }
-}
-inline void ecs::ECS::remove_from_component_list(ID id) {
-    auto entity = &entities[id];
-    for (auto& [hash, irrelevant] : entity->components) {
-        remove_from_component_list(id, hash);
-    }
-}
-inline void ecs::ECS::add_to_component_list(ID id, ecs::Hash hash) {
-    // if the component list does not exist, create it
-    if (component_entity_lists.find(hash) == component_entity_lists.end()) {
-        component_entity_lists[hash] = ComponentEntityList{};
-        component_entity_lists[hash].set(&entities, hash);
+    for (auto& query : queries) {
+        if (query) {
+            query->matches.remove(entity_id);
+        }
     }
-    component_entity_lists.at(hash).push_back(id);
-}
-inline void ecs::ECS::remove_from_component_list(ID id, ecs::Hash hash) {
-    auto entity = &entities[id];
-    component_entity_lists.at(hash).remove_at(entity->components[hash]->component_entity_id);
 }
 inline void ecs::ECS::add_to_active_entities(ID id) {
     active_entities.push_back(id);
@@ -1247,11 +3893,144 @@ inline void ecs::ECS::remove_from_active_entities(ID id) {
 }
 
 inline void ecs::ECS::process(double delta) {
-    for (auto sys : systems) {
-        sys->process(this, delta);
+    // systems within a stage do not conflict and may run concurrently. the commands recorded by a
+    // stage are applied before the next one starts
+    std::vector<System::Ptr> running {};
+    for (const auto& stage : schedule().stages) {
+        // hold the systems of the stage, a system may destroy itself or others while it runs.
+        // systems destroyed by an earlier stage are skipped
+        running.clear();
+        for (ID system : stage) {
+            if (systems[system]) {
+                running.push_back(systems[system]);
+            }
+        }
+        if (running.size() == 1) {
+            running[0]->process(this, delta);
+        } else if (!running.empty()) {
+            thread_pool.parallel_for(0, running.size(), 1, [&](ID begin, ID end) {
+                for (ID i = begin; i < end; i++) {
+                    running[i]->process(this, delta);
+                }
+            });
+        }
+        // everything written from now on, including the commands of the stage, counts as changed
+        // for the systems of the stage when they run next
+        for (const System::Ptr& system : running) {
+            system->m_last_run = change_tick;
+        }
+        change_tick++;
+        flush_commands();
+    }
+    flush_commands();
+    clear_transient();
+}
+
+template<typename T, typename... Fields>
+template<ecs::ID N>
+inline std::tuple_element_t<N, std::tuple<Fields...>>& ecs::ColumnsOf<T, Fields...>::field() {
+    return column_pool->template column<N>()[this->component_entity_id];
+}
+
+template<typename T, typename... Fields>
+template<ecs::ID N>
+inline const std::tuple_element_t<N, std::tuple<Fields...>>&
+    ecs::ColumnsOf<T, Fields...>::field() const {
+    return column_pool->template column<N>()[this->component_entity_id];
+}
+
+inline ecs::CommandBuffer& ecs::ECS::commands() {
+    // remember the buffer of the calling thread so only the first request needs to lock
+    thread_local const ECS*     cached_ecs    = nullptr;
+    thread_local ID             cached_serial = INVALID_ID;
+    thread_local CommandBuffer* cached_buffer = nullptr;
+    if (cached_ecs == this && cached_serial == serial) {
+        return *cached_buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(command_mutex);
+    auto& buffer = command_buffers[std::this_thread::get_id()];
+    if (!buffer) {
+        buffer = std::make_unique<CommandBuffer>();
+    }
+    cached_ecs    = this;
+    cached_serial = serial;
+    cached_buffer = buffer.get();
+    return *buffer;
+}
+
+inline void ecs::ECS::flush_commands() {
+    // take the commands out of the buffers first so that commands recorded while applying end
+    // up in the next flush
+    std::vector<CommandBuffer::Command> pending;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        for (auto& [thread, buffer] : command_buffers) {
+            std::move(buffer->commands.begin(), buffer->commands.end(), std::back_inserter(pending));
+            buffer->clear();
+        }
+    }
+
+    // group the commands by entity while keeping their order per entity. spawns come last
+    std::stable_sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return a.entity < b.entity;
+    });
+    for (auto& command : pending) {
+        command.apply(*this);
     }
 }
 
+inline void ecs::CommandBuffer::spawn(bool active) {
+    commands.push_back({INVALID_ID, [active](ECS& ecs) { ecs.spawn(active); }});
+}
+
+template<typename F>
+inline void ecs::CommandBuffer::spawn(bool active, F&& init) {
+    commands.push_back({INVALID_ID, [active, init = std::forward<F>(init)](ECS& ecs) mutable {
+                            init(ecs[ecs.spawn(active)]);
+                        }});
+}
+
+inline void ecs::CommandBuffer::destroy_entity(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) { ecs.destroy_entity(id); }});
+}
+
+template<typename T, typename... Args>
+inline void ecs::CommandBuffer::assign(EntityID id, Args&&... args) {
+    commands.push_back(
+        {id, [id, args = std::make_tuple(std::forward<Args>(args)...)](ECS& ecs) mutable {
+             if (!ecs.valid(id))
+                 return;
+             std::apply([&](auto&... values) { ecs[id].template assign<T>(std::move(values)...); },
+                        args);
+         }});
+}
+
+template<typename T>
+inline void ecs::CommandBuffer::remove_component(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].template remove_component<T>();
+                            }
+                        }});
+}
+
+inline void ecs::CommandBuffer::activate(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].activate();
+                            }
+                        }});
+}
+
+inline void ecs::CommandBuffer::deactivate(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].deactivate();
+                            }
+                        }});
+}
+
 
 
 
@@ -1262,8 +4041,151 @@ inline void ecs::ECS::process(double delta) {
 
 
 
+// begin --- simd.h --- 
+
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SIMD_H
+#define ECS_SIMD_H
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// vectorised kernels for common update patterns on contiguous arrays, e.g. the runs handed out by
+// ECS::for_each_chunk or the columns of columnar components. float and double use sse2 or avx
+// where available, all other types and the remaining elements use plain loops.
+namespace ecs::simd {
+
+namespace detail {
+
+// the registers and operations used for a type. width 1 means no vector registers are used
+template<typename T>
+struct Lanes {
+    static constexpr ID width = 1;
+};
+
+#if defined(__AVX__)
+template<>
+struct Lanes<float> {
+    using Vec                 = __m256;
+    static constexpr ID width = 8;
+
+    static Vec  set(float x) { return _mm256_set1_ps(x); }
+    static Vec  load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+};
+
+template<>
+struct Lanes<double> {
+    using Vec                 = __m256d;
+    static constexpr ID width = 4;
+
+    static Vec  set(double x) { return _mm256_set1_pd(x); }
+    static Vec  load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+template<>
+struct Lanes<float> {
+    using Vec                 = __m128;
+    static constexpr ID width = 4;
+
+    static Vec  set(float x) { return _mm_set1_ps(x); }
+    static Vec  load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+};
+
+template<>
+struct Lanes<double> {
+    using Vec                 = __m128d;
+    static constexpr ID width = 2;
+
+    static Vec  set(double x) { return _mm_set1_pd(x); }
+    static Vec  load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+};
+#endif
+
+}    // namespace detail
+
+// y[i] += a * x[i]
+template<typename T>
+inline void axpy(T* y, const T* x, T a, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto va = L::set(a);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(y + i, L::add(L::load(y + i), L::mul(va, L::load(x + i))));
+        }
+    }
+    for (; i < count; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+// x[i] *= a
+template<typename T>
+inline void scale(T* x, T a, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto va = L::set(a);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(x + i, L::mul(va, L::load(x + i)));
+        }
+    }
+    for (; i < count; i++) {
+        x[i] *= a;
+    }
+}
+
+// x[i] = min(max(x[i], low), high)
+template<typename T>
+inline void clamp(T* x, T low, T high, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto vl = L::set(low);
+        auto vh = L::set(high);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(x + i, L::min(L::max(L::load(x + i), vl), vh));
+        }
+    }
+    for (; i < count; i++) {
+        x[i] = x[i] < low ? low : (high < x[i] ? high : x[i]);
+    }
+}
+
+}    // namespace ecs::simd
+
+#endif    // ECS_SIMD_H
+
+
+// end --- simd.h --- 
+
+
+
 #endif    // ECS_ECS_CORE_H_
 
 
 // end --- include.h --- 
-
@@ -0,0 +1,67 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_ALIGNED_ALLOCATOR_H
+#define ECS_ALIGNED_ALLOCATOR_H
+
+#include "types.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// alignment of component columns in bytes. a cache line which also suits the widest simd registers
+#ifndef ECS_COLUMN_ALIGNMENT
+#define ECS_COLUMN_ALIGNMENT 64
+#endif
+
+namespace ecs {
+
+/**
+ * @brief Allocator handing out memory aligned to at least the given amount of bytes.
+ *
+ * @tparam T The type to allocate.
+ * @tparam Alignment The alignment in bytes, must be a power of two.
+ */
+template<typename T, std::size_t Alignment = ECS_COLUMN_ALIGNMENT>
+struct AlignedAllocator {
+    using value_type = T;
+
+    static constexpr std::align_val_t alignment {
+        Alignment > alignof(T) ? Alignment : alignof(T)};
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), alignment));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept {
+        ::operator delete(ptr, alignment);
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+// contiguous array whose data is aligned to ECS_COLUMN_ALIGNMENT bytes
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}    // namespace ecs
+
+#endif    // ECS_ALIGNED_ALLOCATOR_H
@@ -0,0 +1,66 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_COMMAND_BUFFER_H
+#define ECS_COMMAND_BUFFER_H
+
+#include "ids.h"
+#include "types.h"
+
+#include <functional>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Records structural changes to apply them to the ECS later on.
+ *
+ * Spawning or destroying entities and adding or removing components while iterating the ECS
+ * invalidates the iterators. Such changes are recorded here instead and applied in bulk once it
+ * is safe, either by ECS::flush_commands() or automatically between the stages of
+ * ECS::process(). Each thread records into its own buffer obtained from ECS::commands().
+ *
+ * Commands referring to entities which have been destroyed in the meantime are skipped.
+ */
+struct CommandBuffer {
+    struct Command {
+        // entity the command applies to, INVALID_ID for spawns
+        ID                        entity;
+        std::function<void(ECS&)> apply;
+    };
+
+    std::vector<Command> commands {};
+
+    // spawns an entity and optionally calls init(entity) to set it up
+    void spawn(bool active = false);
+    template<typename F>
+    void spawn(bool active, F&& init);
+
+    void destroy_entity(EntityID id);
+
+    template<typename T, typename... Args>
+    void assign(EntityID id, Args&&... args);
+
+    template<typename T>
+    void remove_component(EntityID id);
+
+    void activate(EntityID id);
+    void deactivate(EntityID id);
+
+    bool empty() const {
+        return commands.empty();
+    }
+
+    ID size() const {
+        return commands.size();
+    }
+
+    void clear() {
+        commands.clear();
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_COMMAND_BUFFER_H
@@ -10,6 +10,7 @@
 #include "ecs_base.h"
 
 #include <ostream>
+#include <tuple>
 #include <type_traits>
 #include <memory>
 
@@ -50,16 +51,64 @@ struct ComponentOf : public ComponentBase {
 
     // implement static hash function for components
     static Hash hash() {
-        return get_type_hash<T>();
+        return get_type_hash<T, ComponentBase>();
     }
 
     // override the non-static hash function to call the static one
     virtual Hash get_hash() const override {
         return hash();
     }
+
+    // checks at compile time if T overrides the given hook. hooks which are not overridden are
+    // skipped entirely, so plain data components cost no virtual calls
+    static constexpr bool overrides(ComponentHook hook) {
+        switch (hook) {
+            case HOOK_COMPONENT_REMOVED: return overridden(&T::component_removed);
+            case HOOK_ENTITY_ACTIVATED: return overridden(&T::entity_activated);
+            case HOOK_ENTITY_DEACTIVATED: return overridden(&T::entity_deactivated);
+            case HOOK_OTHER_COMPONENT_ADDED: return overridden(&T::other_component_added);
+            default: return false;
+        }
+    }
+
+    private:
+    // &T::hook still names a member of ComponentBase unless T or one of its bases overrides it
+    template<typename R, typename... Args>
+    static constexpr bool overridden(R (ComponentBase::*)(Args...)) {
+        return false;
+    }
+    template<typename M>
+    static constexpr bool overridden(M) {
+        return true;
+    }
 };
 
-using ComponentPtr = std::unique_ptr<ComponentBase>;
+/**
+ * @brief Base for components whose fields are stored column-wise.
+ *
+ * Instead of living inside the component, the values of each field are kept in a separate aligned
+ * array within the pool. Systems touching only some fields of wide components then only load
+ * those, see ECS::column. The component accesses its own values through field<N>(), usually
+ * wrapped into named accessors. Assigning such a component takes either no arguments or one
+ * initial value per field. Views and queries can yield single fields directly, see Field.
+ *
+ * @tparam T The component type itself.
+ * @tparam Fields The types of the fields, one column each.
+ */
+template<typename T, typename... Fields>
+struct ColumnsOf : public ComponentOf<T> {
+    using column_types = std::tuple<Fields...>;
+
+    // the pool holding the columns, set when the component is assigned so that accessing a field
+    // requires no lookup
+    ComponentPool<T>* column_pool = nullptr;
+
+    // the value of the N-th field of this component
+    template<ID N>
+    std::tuple_element_t<N, column_types>& field();
+    template<ID N>
+    const std::tuple_element_t<N, column_types>& field() const;
+};
 
 } // namespace ecs_
 
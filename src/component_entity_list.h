@@ -5,41 +5,22 @@
 #ifndef ECS_COMPONENT_ENTITY_LIST_H
 #define ECS_COMPONENT_ENTITY_LIST_H
 
-#include "entity.h"
 #include "types.h"
-#include "vector_compact.h"
-
-#include <vector>
+#include "vector_indexed.h"
 
 namespace ecs {
 
-struct ComponentEntityList : CompactVector<ID> {
-    // pointer to the ECS
-    std::vector<Entity>* entities_ = nullptr;
-
+// dense list of the entities owning a component of a specific type. the position of an entity
+// in this list equals the position of its component within the pool of that type. the position
+// of each entity is tracked so that lookups and removals are constant time.
+struct ComponentEntityList : IndexedVector {
     // hash of the component
     Hash comp_hash_ = Hash{INVALID_HASH};
 
-    // set ecs_ and component hash via some function to allow empty constructions
-    void set(std::vector<Entity>* entities, Hash component_hash) {
-        this->entities_      = entities;
-        this->comp_hash_     = component_hash;
-    }
-
-    // overloaded
-    void moved(ID from, ID to) override {
-        // TODO
-//        (*entities_)[elements[to]].components[comp_hash_]->component_entity_id = to;
+    // set the component hash via some function to allow empty constructions
+    void set(Hash component_hash) {
+        this->comp_hash_ = component_hash;
     }
-    void removed(ID id) override {
-        // TODO
-//        (*entities_)[elements[id]].components[comp_hash_]->component_entity_id = INVALID_ID;
-    }
-    void added(ID id) override {
-        // TODO
-//        (*entities_)[elements[id]].components[comp_hash_]->component_entity_id = id;
-    }
-
 };
 
 }    // namespace ecs_
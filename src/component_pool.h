@@ -0,0 +1,295 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_COMPONENT_POOL_H
+#define ECS_COMPONENT_POOL_H
+
+#include "aligned_allocator.h"
+#include "component_entity_list.h"
+#include "types.h"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Type-erased interface of a component pool.
+ *
+ * Every component type gets exactly one pool which is organised as a sparse set: the components
+ * are stored in a dense array, the entities owning them in a parallel dense array which also
+ * maps each entity id back to the position of its component. Lookups, insertions and removals
+ * are constant time and iterating a pool walks packed memory.
+ */
+struct ComponentPoolBase {
+    // dense array of the entities owning a component of this type
+    ComponentEntityList entities {};
+    // components of transient pools only live for one call to ECS::process()
+    bool                transient = false;
+
+    virtual ~ComponentPoolBase() = default;
+
+    bool contains(ID entity) const {
+        return entities.contains(entity);
+    }
+
+    ID index_of(ID entity) const {
+        return entities.index_of(entity);
+    }
+
+    ID size() const {
+        return entities.size();
+    }
+
+    // amount of components which fit into the storage without allocating
+    virtual ID capacity() const = 0;
+
+    // access the component of the given entity through its base
+    virtual ComponentBase* get_base(ID entity) = 0;
+
+    // removes the component of the given entity, moving the last component into its place
+    virtual void remove(ID entity) = 0;
+
+    // exchanges the components at the given positions
+    virtual void swap_at(ID a, ID b) = 0;
+
+    // removes all components
+    virtual void clear() = 0;
+};
+
+// one aligned array per field of a component declaring column_types, see ColumnsOf. components
+// storing their fields themselves get no columns
+template<typename T, typename = void>
+struct ColumnStorage {
+    using type = std::tuple<>;
+};
+
+template<typename T>
+struct ColumnStorage<T, std::void_t<typename T::column_types>> {
+    template<typename... Fields>
+    static std::tuple<AlignedVector<Fields>...> make(std::tuple<Fields...>*);
+
+    using type = decltype(make(static_cast<typename T::column_types*>(nullptr)));
+};
+
+// fixed size view onto a column, see ECS::column. the column cannot be resized through it since
+// it has to stay parallel to the components
+template<typename E>
+struct ColumnSpan {
+    E* values = nullptr;
+    ID count  = 0;
+
+    E* data() const {
+        return values;
+    }
+    ID size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    E& operator[](ID index) const {
+        return values[index];
+    }
+    E* begin() const {
+        return values;
+    }
+    E* end() const {
+        return values + count;
+    }
+};
+
+/**
+ * @brief Sparse set of components of type T.
+ *
+ * Components with column_types additionally keep one array per field, parallel to the components.
+ *
+ * @tparam T The component type stored in this pool.
+ */
+template<typename T>
+struct ComponentPool : public ComponentPoolBase {
+    using Component = T;
+    using Columns   = typename ColumnStorage<T>::type;
+
+    static constexpr bool columnar = std::tuple_size_v<Columns> > 0;
+
+    // dense array of the components, parallel to the entity list
+    std::vector<T>    components {};
+    // dense arrays of the fields of columnar components, parallel to the components
+    Columns           columns {};
+    // the tick at which each component was last accessed mutably, parallel to the components.
+    // kept apart from the components so marking a column as changed does not load them
+    std::vector<Tick> ticks {};
+
+    // columnar components are default constructed, the arguments initialise their fields instead
+    template<typename... Args>
+    T& emplace(ID entity, Args&&... args) {
+        if constexpr (columnar) {
+            components.emplace_back();
+            components.back().column_pool = this;
+            emplace_columns(std::index_sequence_for<Args...> {}, std::forward<Args>(args)...);
+        } else {
+            components.emplace_back(std::forward<Args>(args)...);
+        }
+        ticks.emplace_back();
+        entities.push_back(entity);
+        components.back().component_entity_id = components.size() - 1;
+        return components.back();
+    }
+
+    // reserves storage for the given amount of components
+    void reserve(ID capacity) {
+        components.reserve(capacity);
+        ticks.reserve(capacity);
+        entities.reserve(capacity);
+        std::apply([&](auto&... column) { (column.reserve(capacity), ...); }, columns);
+    }
+
+    // the values of the N-th field of all components
+    template<ID N>
+    auto& column() {
+        return std::get<N>(columns);
+    }
+
+    T* get(ID entity) {
+        ID index = index_of(entity);
+        return index != INVALID_ID ? &components[index] : nullptr;
+    }
+
+    // marks the components at the positions [begin, end) as changed at the given tick
+    void touch(ID begin, ID end, Tick tick) {
+        std::fill(ticks.data() + begin, ticks.data() + end, tick);
+    }
+
+    T& operator[](ID index) {
+        return components[index];
+    }
+
+    ID capacity() const override {
+        return components.capacity();
+    }
+
+    ComponentBase* get_base(ID entity) override {
+        return get(entity);
+    }
+
+    void remove(ID entity) override {
+        ID index = index_of(entity);
+        if (index == INVALID_ID)
+            return;
+
+        // swap and pop all dense arrays, the entity list updates its own positions
+        if (index != components.size() - 1) {
+            components[index]                     = std::move(components.back());
+            components[index].component_entity_id = index;
+            ticks[index]                          = ticks.back();
+            std::apply([&](auto&... column) { ((column[index] = std::move(column.back())), ...); },
+                       columns);
+        }
+        components.pop_back();
+        ticks.pop_back();
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, columns);
+        entities.remove_at(index);
+    }
+
+    void swap_at(ID a, ID b) override {
+        if (a == b)
+            return;
+        std::swap(components[a], components[b]);
+        components[a].component_entity_id = a;
+        components[b].component_entity_id = b;
+        std::swap(ticks[a], ticks[b]);
+        std::apply([&](auto&... column) { (std::swap(column[a], column[b]), ...); }, columns);
+        entities.swap_at(a, b);
+    }
+
+    // sorts the components at the positions [begin, end) by the given comparator
+    template<typename Compare>
+    void sort(ID begin, ID end, Compare compare, SortMode mode = SORT_FULL) {
+        if (mode == SORT_INSERTION) {
+            for (ID i = begin + 1; i < end; i++) {
+                for (ID j = i; j > begin && compare(components[j], components[j - 1]); j--) {
+                    swap_at(j, j - 1);
+                }
+            }
+            return;
+        }
+
+        // sort the positions first so the components are only moved once into place
+        std::vector<ID> order(end - begin);
+        std::iota(order.begin(), order.end(), begin);
+        std::sort(order.begin(), order.end(), [&](ID a, ID b) {
+            return compare(components[a], components[b]);
+        });
+
+        // follow the cycles of the permutation, order[i] marks position i as done once placed
+        for (ID i = begin; i < end; i++) {
+            ID current = i;
+            while (true) {
+                ID next                = order[current - begin];
+                order[current - begin] = current;
+                if (next == i || next == current)
+                    break;
+                swap_at(current, next);
+                current = next;
+            }
+        }
+    }
+
+    // keeps the components of the entities for which keep(entity) holds and removes all others in
+    // a single pass. unlike repeated removals, this preserves the order of the kept components
+    template<typename F>
+    void retain(F&& keep) {
+        ID kept = 0;
+        for (ID index = 0; index < components.size(); index++) {
+            ID entity = entities[index];
+            if (!keep(entity)) {
+                entities.indices[entity] = INVALID_ID;
+                continue;
+            }
+            if (kept != index) {
+                components[kept]                     = std::move(components[index]);
+                components[kept].component_entity_id = kept;
+                ticks[kept]                          = ticks[index];
+                entities[kept]                       = entity;
+                entities.indices[entity]             = kept;
+                std::apply([&](auto&... column) { ((column[kept] = std::move(column[index])), ...); },
+                           columns);
+            }
+            kept++;
+        }
+        components.erase(components.begin() + kept, components.end());
+        ticks.resize(kept);
+        std::apply([&](auto&... column) { (column.erase(column.begin() + kept, column.end()), ...); },
+                   columns);
+        entities.elements.resize(kept);
+    }
+
+    void clear() override {
+        components.clear();
+        ticks.clear();
+        std::apply([](auto&... column) { (column.clear(), ...); }, columns);
+        entities.clear();
+    }
+
+    private:
+    template<std::size_t... I, typename... Args>
+    void emplace_columns(std::index_sequence<I...>, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            std::apply([](auto&... column) { (column.emplace_back(), ...); }, columns);
+        } else {
+            static_assert(sizeof...(Args) == std::tuple_size_v<Columns>,
+                          "columnar components take either no arguments or one per field");
+            (std::get<I>(columns).emplace_back(std::forward<Args>(args)), ...);
+        }
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_COMPONENT_POOL_H
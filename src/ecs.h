@@ -5,6 +5,7 @@
 #ifndef ECS_ECS_ECS_H_
 #define ECS_ECS_ECS_H_
 
+#include "command_buffer.h"
 #include "component.h"
 #include "component_entity_list.h"
 #include "ecs_base.h"
@@ -12,15 +13,33 @@
 #include "entity_iterator.h"
 #include "entity_subset.h"
 #include "event.h"
+#include "group.h"
 #include "hash.h"
+#include "observer.h"
+#include "query.h"
 #include "system.h"
+#include "system_schedule.h"
+#include "terms.h"
+#include "thread_pool.h"
 #include "types.h"
+#include "vector_indexed.h"
 #include "vector_recycling.h"
+#include "view.h"
 
 #include <algorithm>
+#include <atomic>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ecs {
@@ -32,18 +51,47 @@ namespace ecs {
  * to create entities, add/remove components, and process systems.
  */
 struct ECS : public ECSBase {
-    std::unordered_map<Hash, ComponentEntityList>                     component_entity_lists {};
     std::vector<Entity>                                               entities {};
-    CompactVector<ID>                                                 active_entities {};
+    std::vector<ID>                                                   free_entities {};
+    IndexedVector                                                     active_entities {};
+    // list handed out by queries over component types without a pool
+    std::vector<ID>                                                   no_entities {};
 
     RecyclingVector<System::Ptr>                                      systems {nullptr};
-    std::unordered_map<Hash, RecyclingVector<EventListenerBase::Ptr>> event_listener {};
+    SystemSchedule                                                    system_schedule {};
+    bool                                                              schedule_outdated = true;
+    std::vector<RecyclingVector<EventListenerBase::Ptr>>              event_listener {};
+
+    ThreadPool                                                        thread_pool {};
+
+    // registered queries indexed by their type hash, and the ones affected by each component type
+    std::vector<std::unique_ptr<QueryBase>>                           queries {};
+    std::vector<std::vector<QueryBase*>>                              component_queries {};
+    std::mutex                                                        query_mutex {};
+
+    // owning groups indexed by their type hash, and the group owning each component type
+    std::vector<std::unique_ptr<GroupBase>>                           groups {};
+    std::vector<GroupBase*>                                           owning_groups {};
+
+    // all observers, and the ones recording assignments and removals of each component type
+    std::vector<std::unique_ptr<Observer>>                            observers {};
+    std::vector<std::vector<Observer*>>                               added_observers {};
+    std::vector<std::vector<Observer*>>                               removed_observers {};
+
+    // one command buffer per recording thread
+    std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer>> command_buffers {};
+    std::mutex                                                          command_mutex {};
+    // distinguishes ecs instances which happen to share an address
+    const ID serial = next_serial();
 
     // Grant Entity access to private members.
     friend Entity;
     friend ComponentEntityList;
 
-    ECS() = default;
+    // thread_count is the amount of threads used for parallel work including the calling one.
+    // zero uses all hardware threads
+    explicit ECS(ID thread_count = 0)
+        : thread_pool(thread_count) {}
 
     // Delete copy constructor and copy assignment operator
     ECS(const ECS&) = delete;
@@ -58,11 +106,118 @@ struct ECS : public ECSBase {
     }
 
     public:
+    // the command buffer of the calling thread
+    CommandBuffer& commands();
+    // applies and clears the commands recorded by all threads. must not run concurrently to
+    // iterations or other structural changes
+    void           flush_commands();
+
     EntityID spawn(bool active = false);
+
+    /**
+     * @brief Spawns multiple entities owning the same component types at once.
+     *
+     * Entity slots and component storage are reserved up front and the components are constructed
+     * in place by their default constructor. As all components of an entity are created together,
+     * no other_component_added notifications are sent.
+     *
+     * @tparam Types The component types each entity receives.
+     * @param count Amount of entities to spawn.
+     * @param active Whether the entities are activated once they are set up.
+     * @param init Called as init(entity, components...) for each entity once it owns all of its
+     *             components and before activating it. It may assign further components but must
+     *             neither destroy the entity nor remove or reassign any of Types.
+     * @return The ids of the spawned entities.
+     */
+    template<typename... Types, typename F>
+    std::vector<EntityID> spawn_batch(ID count, bool active, F&& init);
+    template<typename... Types>
+    std::vector<EntityID> spawn_batch(ID count, bool active = false);
+
+    // reserves storage for the given amount of components of type T so that assigning up to that
+    // many components does not allocate
+    template<typename T>
+    void reserve(ID capacity) {
+        pool<T>()->reserve(capacity);
+    }
+
+    // marks T as a frame-temporary component type. all components of such a type are removed at
+    // the end of each process() while their storage is kept, so creating them during the next
+    // frame does not allocate again
+    template<typename T>
+    void set_transient(bool transient = true) {
+        pool<T>()->transient = transient;
+    }
+
+    // removes the components of all transient types
+    void clear_transient();
+
+    /**
+     * @brief Sorts the components of type T and with them the iteration order of queries over T.
+     *
+     * If T is owned by a group, the members of the group and the remaining components are sorted
+     * separately and the other pools of the group follow the new order.
+     *
+     * @param compare Strict weak ordering called as compare(const T&, const T&).
+     * @param mode SORT_INSERTION is linear for nearly sorted pools.
+     */
+    template<typename T, typename Compare>
+    void sort(Compare compare, SortMode mode = SORT_FULL);
+
+    // arranges the components of type T in the order of the components of type U. components of
+    // entities without U end up behind all others. throws std::logic_error if T is owned by a group
+    template<typename T, typename U>
+    void sort_as();
+
+    // the values of the N-th field of all components of the columnar type T. the value at index i
+    // belongs to the entity pool<T>()->entities[i]. like queries, this creates no pool so that
+    // concurrently running systems may call it, the column is empty if there is none yet. unless
+    // T is const, all components of the type are marked as changed, see Changed
+    template<typename T, ID N>
+    auto column() {
+        using Type    = std::remove_const_t<T>;
+        using Column  = std::tuple_element_t<N, typename ComponentPool<Type>::Columns>;
+        using Element = std::conditional_t<std::is_const_v<T>,
+                                           const typename Column::value_type,
+                                           typename Column::value_type>;
+
+        auto pool = static_cast<ComponentPool<Type>*>(find_pool(Type::hash()));
+        if (pool == nullptr)
+            return ColumnSpan<Element> {};
+        if constexpr (!std::is_const_v<T>) {
+            pool->touch(0, pool->size(), change_tick);
+        }
+        Column& column = pool->template column<N>();
+        return ColumnSpan<Element> {column.data(), column.size()};
+    }
+
+    // removes the component of type T from all entities owning one, including inactive ones
+    template<typename T>
+    void remove_all();
+    // removes the component of type T from the given entities with a single pass over its pool
+    template<typename T>
+    void remove_all(const std::vector<EntityID>& ids);
+    template<typename T, typename... RTypes>
+    void remove_all(EntitySubSet<RTypes...> subset);
+
+    // assigns a component of type T constructed from args to each of the given entities. existing
+    // components of that type are replaced, just like assign does
+    template<typename T, typename... Args>
+    void assign_all(const std::vector<EntityID>& ids, const Args&... args);
+    template<typename T, typename... RTypes, typename... Args>
+    void assign_all(EntitySubSet<RTypes...> subset, const Args&... args);
+
     void     destroy_entity(EntityID id) override;
     void     destroy_all_entities();
     void     destroy_all_systems();
 
+    // checks if the id refers to an entity which has not been destroyed since
+    bool valid(EntityID id) const {
+        return id.id < entities.size()
+               && entities[id.id].entity_id.id == id.id
+               && entities[id.id].entity_id.generation == id.generation;
+    }
+
     // operators to get an entity from an id
     Entity& operator[](ID id) {
         return entities[id];
@@ -81,26 +236,203 @@ struct ECS : public ECSBase {
     void entity_activated(EntityID id) override;
     void entity_deactivated(EntityID id) override;
 
+    static ID next_serial() {
+        static std::atomic<ID> counter {0};
+        return counter++;
+    }
+
+    // returns the slot of a destroyed entity or appends a new one
+    ID acquire_slot();
+
+    // removes all components of the given pool from their entities, keeping its storage
+    void clear_pool(Hash hash);
+
+    // creates an observer and lists it for the given component type
+    Observer& add_observer(std::vector<std::vector<Observer*>>& table, Hash hash);
+
     // functions to manage the lists
-    void add_to_component_list(ID entity);
-    void remove_from_component_list(ID entity);
-    void add_to_component_list(ID entity, Hash hash);
-    void remove_from_component_list(ID entity, Hash hash);
     void add_to_active_entities(ID entity);
     void remove_from_active_entities(ID entity);
 
+    // splits the first pool into runs of matching entities whose components are adjacent in all
+    // pools and passes them to func. the runs of the types which are not const are marked as
+    // changed
+    template<typename... Types, typename... Pools, std::size_t... I, typename F>
+    void chunk_runs(std::tuple<Pools*...>& pools, std::index_sequence<I...>, F& func) {
+        static const Signature mask     = signature_of<typename Pools::Component...>();
+        auto                   matching = [&](ID entity) {
+            return entities[entity].active() && entities[entity].matches(mask);
+        };
+
+        auto& driver = *std::get<0>(pools);
+        for (ID begin = 0; begin < driver.size();) {
+            ID first = driver.entities[begin];
+            if (!matching(first)) {
+                begin++;
+                continue;
+            }
+
+            ID   start[] {std::get<I>(pools)->index_of(first)...};
+            auto adjacent = [&](ID entity, ID offset) {
+                return ((start[I] + offset < std::get<I>(pools)->size()
+                         && std::get<I>(pools)->entities[start[I] + offset] == entity)
+                        && ...);
+            };
+
+            ID end = begin + 1;
+            while (end < driver.size() && matching(driver.entities[end])
+                   && adjacent(driver.entities[end], end - begin)) {
+                end++;
+            }
+
+            ((std::is_const_v<Types>
+                  ? void()
+                  : std::get<I>(pools)->touch(start[I], start[I] + end - begin, change_tick)),
+             ...);
+            func(static_cast<Types*>(&std::get<I>(pools)->components[start[I]])..., end - begin);
+            begin = end;
+        }
+    }
+
+    // returns the entity list of the pool with the fewest components among the required types of
+    // the given terms. every entity matching a query over these terms is contained in it, so it is
+    // the cheapest one to iterate. no pools are created here so that concurrently running systems
+    // may query freely.
+    template<typename... Terms>
+    inline std::vector<ID>* smallest_list() {
+        static_assert((Term<Terms>::required || ...), "a query requires at least one component type");
+
+        ComponentPoolBase* smallest = nullptr;
+        bool               missing  = false;
+        auto               consider = [&](ComponentPoolBase* pool) {
+            // a missing pool means that no entity can match
+            if (pool == nullptr) {
+                missing = true;
+            } else if (smallest == nullptr || pool->size() < smallest->size()) {
+                smallest = pool;
+            }
+        };
+        ((Term<Terms>::required ? consider(Term<Terms>::find(this)) : void()), ...);
+
+        return missing || smallest == nullptr ? &no_entities : &smallest->entities.elements;
+    }
+
     public:
     template<typename K, typename... R>
     inline EntitySubSet<K, R...> each() {
-        auto  hash = K::hash();
-        auto* ids  = &component_entity_lists[hash].elements;
-        return EntitySubSet<K, R...> {ids, &entities};
+        return EntitySubSet<K, R...> {smallest_list<K, R...>(), &entities};
+    }
+
+    // iterates the active entities owning all given components, yielding (id, components...).
+    // Changed terms only match components written after the given tick, usually the one at which
+    // the calling system last ran, see System::last_run
+    template<typename K, typename... R>
+    inline View<K, R...> view(Tick since = 0) {
+        return View<K, R...> {smallest_list<K, R...>(),
+                              &entities,
+                              find_term_pools<K, R...>(this),
+                              change_tick,
+                              since};
+    }
+
+    /**
+     * @brief Returns the persistent query over the active entities owning all given components.
+     *
+     * The query is registered by the first call and kept up to date from then on, so iterating it
+     * requires no filtering. Registering a query walks the matching entities once.
+     */
+    template<typename K, typename... R>
+    Query<K, R...>& query();
+
+    /**
+     * @brief Returns the owning group of the given component types.
+     *
+     * The group is registered by the first call. From then on, the components of all entities
+     * owning every type are kept at the front of the pools in the same order. A component type can
+     * be owned by one group only, registering a second group for it throws std::logic_error.
+     * Groups should be registered before systems run concurrently.
+     */
+    template<typename K, typename... R>
+    Group<K, R...>& group();
+
+    /**
+     * @brief Returns a new observer recording the entities which are assigned a component of type T.
+     *
+     * Observers live as long as the ecs and should be registered before systems run concurrently.
+     * The observer recording removals also records the components of destroyed entities.
+     */
+    template<typename T>
+    Observer& observe_added();
+    template<typename T>
+    Observer& observe_removed();
+
+    // returns a new observer recording the entities which start matching the query over the given
+    // terms, see query(). entities matching already when the observer is registered are skipped
+    template<typename K, typename... R>
+    Observer& observe_entered();
+
+    // iterates all active entities
+    inline EntitySubSet<> each_active() {
+        return EntitySubSet<> {&active_entities.elements, &entities};
+    }
+
+    /**
+     * @brief Calls func(entity) for each active entity with all the given components in parallel.
+     *
+     * The matching entities are split into chunks of grain_size entities which are processed by
+     * the thread pool. Each entity is visited by exactly one thread, so func may freely modify the
+     * components of the entity it is given. It must not touch other entities nor add or remove
+     * components or entities while the iteration is running.
+     *
+     * @param func The function to call for each matching entity.
+     * @param grain_size Amount of entities per chunk. Zero picks a few chunks per thread.
+     */
+    template<typename K, typename... R, typename F>
+    inline void par_each(F&& func, ID grain_size = 0) {
+        static_assert(unfiltered<K, R...>, "Changed terms are only supported by views");
+
+        const std::vector<ID>& ids      = *smallest_list<K, R...>();
+        const Signature        mask     = required_of<K, R...>();
+        const Signature        excluded = excluded_of<K, R...>();
+
+        thread_pool.parallel_for(0, ids.size(), grain_size, [&](ID begin, ID end) {
+            for (ID i = begin; i < end; i++) {
+                Entity& entity = entities[ids[i]];
+                if (entity.active() && entity.matches(mask, excluded)) {
+                    func(entity);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Calls func(k, r..., count) for contiguous runs of active entities owning all given
+     * components.
+     *
+     * The pointers point to count consecutive components within the pools of the respective types,
+     * so the function can process them with plain, vectorisable loops. A run ends as soon as the
+     * next entity does not match or its components are not adjacent within every pool. Pools which
+     * store their components in the same order yield runs spanning the entire pool. The runs of
+     * component types which are not const are marked as changed, see Changed.
+     *
+     * @param func The function to call for each run.
+     */
+    template<typename K, typename... R, typename F>
+    inline void for_each_chunk(F&& func) {
+        auto pools = find_term_pools<K, R...>(this);
+        // a missing pool means that no entity can match
+        if (std::apply([](auto*... pool) { return ((pool == nullptr) || ...); }, pools))
+            return;
+        chunk_runs<K, R...>(pools, std::index_sequence_for<K, R...> {}, func);
     }
 
     template<typename K, typename... R>
     inline ID first() {
-        for (ID id : component_entity_lists[K::hash()].entities) {
-            if (entities[id].has<K, R...>()) {
+        static_assert(unfiltered<K, R...>, "Changed terms are only supported by views");
+        static const Signature mask     = required_of<K, R...>();
+        static const Signature excluded = excluded_of<K, R...>();
+        for (ID id : *smallest_list<K, R...>()) {
+            if (entities[id].active() && entities[id].matches(mask, excluded)) {
                 return id;
             }
         }
@@ -109,10 +441,13 @@ struct ECS : public ECSBase {
 
     template<typename Event>
     inline void emit_event(const Event& event) {
-        Hash hash = get_type_hash<Event>();
-        if (event_listener.find(hash) == event_listener.end())
+        Hash hash = get_type_hash<Event, EventListenerBase>();
+        if (hash >= event_listener.size())
             return;
         for (auto listener : event_listener[hash]) {
+            // skip slots of destroyed listeners
+            if (!listener)
+                continue;
             auto l = reinterpret_cast<EventListener<Event>*>(listener.get());
             l->receive(this, event);
         }
@@ -122,13 +457,24 @@ struct ECS : public ECSBase {
     SystemID create_system(Args&&... args) {
         std::shared_ptr<T> system = std::make_shared<T>(std::forward<Args>(args)...);
         ID pos = systems.push_back(system);
+        schedule_outdated = true;
         return SystemID{pos};
     }
     void destroy_system(SystemID id) override {
-        if (id >= systems.size())
+        if (id >= systems.size() || !systems[id])
             return;
         systems[id]->destroyed();
         systems.remove_at(id);
+        schedule_outdated = true;
+    }
+
+    // the order in which process() runs the systems, rebuilt whenever systems change
+    const SystemSchedule& schedule() {
+        if (schedule_outdated) {
+            system_schedule.build(systems);
+            schedule_outdated = false;
+        }
+        return system_schedule;
     }
 
     template<typename T, typename... Args>
@@ -136,14 +482,14 @@ struct ECS : public ECSBase {
         std::shared_ptr<T> listener = std::make_shared<T>(std::forward<Args>(args)...);
         auto hash = listener->hash;
 
-        if (event_listener.find(hash) == event_listener.end()) {
-            event_listener[hash] = {nullptr};
+        if (hash >= event_listener.size()) {
+            event_listener.resize(hash + 1, RecyclingVector<EventListenerBase::Ptr> {nullptr});
         }
         ID pos = event_listener[hash].push_back(listener);
         return EventListenerID{pos, hash};
     }
     void destroy_listener(EventListenerID id) override {
-        event_listener[id.operator Hash()].remove_at((ID)id);
+        event_listener[id.hash].remove_at(id.id);
     }
 
     void                 process(double delta);
@@ -176,12 +522,14 @@ struct ECS : public ECSBase {
         }
         os << std::endl;
 
-        os << "Component Entity List: " << std::endl;
+        os << "Component Pools: " << std::endl;
         os << "-----------------------" << std::endl;
-        for (const auto& pair : ecs1.component_entity_lists) {
-            os << "Component Hash: " << std::setw(20) << pair.first.hash_code() << std::endl;
+        for (Hash hash = 0; hash < ecs1.component_pools.size(); hash++) {
+            if (!ecs1.component_pools[hash])
+                continue;
+            os << "Component Hash: " << std::setw(20) << hash << std::endl;
             os << "Entities: " << std::endl;
-            for (const auto& id : pair.second) {
+            for (const auto& id : ecs1.component_pools[hash]->entities) {
                 os << std::setw(10);
                 if (id != INVALID_ID) {
                     os << id << " | Active: " << (ecs1.entities[id].active() ? "true" : "false");
@@ -202,19 +550,256 @@ struct ECS : public ECSBase {
 
 
 
+inline ecs::ID ecs::ECS::acquire_slot() {
+    // reuse the slot of a destroyed entity if possible
+    ID slot;
+    if (!free_entities.empty()) {
+        slot = free_entities.back();
+        free_entities.pop_back();
+    } else {
+        slot = entities.size();
+        entities.emplace_back(Entity{this});
+    }
+
+    Entity& entity   = entities[slot];
+    entity.entity_id = EntityID{slot, entity.entity_id.generation};
+    return slot;
+}
+
+template<typename T, typename Compare>
+inline void ecs::ECS::sort(Compare compare, SortMode mode) {
+    Hash hash = T::hash();
+    auto pool = static_cast<ComponentPool<T>*>(find_pool(hash));
+    if (pool == nullptr)
+        return;
+
+    GroupBase* group = hash < owning_groups.size() ? owning_groups[hash] : nullptr;
+    if (group == nullptr) {
+        pool->sort(0, pool->size(), compare, mode);
+        return;
+    }
+
+    pool->sort(0, group->size, compare, mode);
+    pool->sort(group->size, pool->size(), compare, mode);
+    for (ComponentPoolBase* other : group->pools) {
+        if (other == pool)
+            continue;
+        for (ID index = 0; index < group->size; index++) {
+            other->swap_at(other->index_of(pool->entities[index]), index);
+        }
+    }
+}
+
+template<typename T, typename U>
+inline void ecs::ECS::sort_as() {
+    Hash       hash      = T::hash();
+    auto       pool      = find_pool(hash);
+    const auto reference = find_pool(U::hash());
+    // moving the components would break the arrangement of the group
+    if (hash < owning_groups.size() && owning_groups[hash] != nullptr) {
+        throw std::logic_error("ecs: sort_as cannot rearrange a component type owned by a group");
+    }
+    if (pool == nullptr || reference == nullptr)
+        return;
+
+    ID position = 0;
+    for (ID entity : reference->entities) {
+        ID index = pool->index_of(entity);
+        if (index != INVALID_ID) {
+            pool->swap_at(index, position++);
+        }
+    }
+}
+
+template<typename T>
+inline void ecs::ECS::remove_all() {
+    clear_pool(T::hash());
+}
+
+inline void ecs::ECS::clear_pool(Hash hash) {
+    ComponentPoolBase* pool = find_pool(hash);
+    if (pool == nullptr)
+        return;
+
+    // every member of an owning group loses this component, so the group simply becomes empty
+    if (hash < owning_groups.size() && owning_groups[hash]) {
+        owning_groups[hash]->size = 0;
+    }
+
+    bool notify = hooked[HOOK_COMPONENT_REMOVED].test(hash);
+    for (ID index = 0; index < pool->size(); index++) {
+        Entity& entity = entities[pool->entities[index]];
+        if (notify) {
+            pool->get_base(entity.entity_id)->component_removed();
+        }
+        entity.signature.reset(hash);
+        component_removed(hash, entity.entity_id);
+    }
+    pool->clear();
+}
+
+inline void ecs::ECS::clear_transient() {
+    for (Hash hash = 0; hash < component_pools.size(); hash++) {
+        if (component_pools[hash] && component_pools[hash]->transient) {
+            clear_pool(hash);
+        }
+    }
+}
+
+template<typename T>
+inline void ecs::ECS::remove_all(const std::vector<EntityID>& ids) {
+    Hash hash = T::hash();
+    auto pool = static_cast<ComponentPool<T>*>(find_pool(hash));
+    if (pool == nullptr)
+        return;
+
+    ID removed = 0;
+    for (EntityID id : ids) {
+        if (!valid(id) || !entities[id].signature.test(hash))
+            continue;
+        if constexpr (T::overrides(HOOK_COMPONENT_REMOVED)) {
+            pool->get(id)->component_removed();
+        }
+        entities[id].signature.reset(hash);
+        component_removed(hash, id);
+        removed++;
+    }
+
+    // drop the components of all entities which lost their bit at once
+    if (removed > 0) {
+        pool->retain([&](ID entity) { return entities[entity].signature.test(hash); });
+    }
+}
+
+template<typename T, typename... RTypes>
+inline void ecs::ECS::remove_all(EntitySubSet<RTypes...> subset) {
+    // collect the entities first as removing the components would invalidate the iteration
+    std::vector<EntityID> ids;
+    for (Entity& entity : subset) {
+        ids.push_back(entity.entity_id);
+    }
+    remove_all<T>(ids);
+}
+
+template<typename T, typename... Args>
+inline void ecs::ECS::assign_all(const std::vector<EntityID>& ids, const Args&... args) {
+    remove_all<T>(ids);
+
+    Hash              hash = T::hash();
+    ComponentPool<T>* pool = this->pool<T>();
+    pool->reserve(pool->size() + ids.size());
+
+    for (EntityID id : ids) {
+        // skips stale ids as well as ids listed more than once
+        if (!valid(id) || entities[id].signature.test(hash))
+            continue;
+
+        Entity& entity         = entities[id];
+        T&      component      = pool->emplace(id, args...);
+        component.ecs          = this;
+        component.component_id = ComponentID{id, hash};
+        pool->ticks.back()     = change_tick;
+        entity.signature.set(hash);
+
+        const Signature& notified = hooked[HOOK_OTHER_COMPONENT_ADDED];
+        entity.for_each_component(notified, [&](Hash other, ComponentBase* comp) {
+            if (other != hash) {
+                comp->other_component_added(hash);
+            }
+        });
+        if constexpr (T::overrides(HOOK_OTHER_COMPONENT_ADDED)) {
+            entity.for_each_component([&](Hash other, ComponentBase*) {
+                if (other != hash) {
+                    component.other_component_added(other);
+                }
+            });
+        }
+
+        if constexpr (T::overrides(HOOK_ENTITY_ACTIVATED)) {
+            if (entity.active()) {
+                component.entity_activated();
+            }
+        }
+
+        // last, as groups may move the component within its pool
+        component_added(hash, id);
+    }
+}
+
+template<typename T, typename... RTypes, typename... Args>
+inline void ecs::ECS::assign_all(EntitySubSet<RTypes...> subset, const Args&... args) {
+    std::vector<EntityID> ids;
+    for (Entity& entity : subset) {
+        ids.push_back(entity.entity_id);
+    }
+    assign_all<T>(ids, args...);
+}
+
 inline ecs::EntityID ecs::ECS::spawn(bool active) {
+    Entity& entity = entities[acquire_slot()];
 
-    entities.emplace_back(Entity{this});
-    entities.back().entity_id = EntityID{entities.size() - 1};
+    if (active) {
+        entity.activate();
+    }
+
+    return entity.entity_id;
+}
+
+template<typename... Types, typename F>
+inline std::vector<ecs::EntityID> ecs::ECS::spawn_batch(ID count, bool active, F&& init) {
+    std::vector<EntityID> ids;
+    ids.reserve(count);
+
+    // reserve everything up front so the batch causes at most one reallocation per container
+    ID reused = std::min<ID>(count, free_entities.size());
+    entities.reserve(entities.size() + count - reused);
+    for (ID i = 0; i < count; i++) {
+        ids.push_back(entities[acquire_slot()].entity_id);
+    }
+
+    std::tuple<ComponentPool<Types>*...> pools {pool<Types>()...};
+    std::apply([&](auto*... pool) { (pool->reserve(pool->size() + count), ...); }, pools);
+
+    static const Signature mask = signature_of<Types...>();
+    for (EntityID id : ids) {
+        Entity& entity = entities[id];
+        auto construct = [&](auto* pool) {
+            auto& component        = pool->emplace(id);
+            component.ecs          = this;
+            component.component_id = ComponentID{id, pool->entities.comp_hash_};
+            pool->ticks.back()     = change_tick;
+        };
+        std::apply([&](auto*... pool) { (construct(pool), ...); }, pools);
+        entity.signature |= mask;
+        (component_added(Types::hash(), id), ...);
+        // joining a group may have moved the components, so look them up again for init
+        std::apply([&](auto*... pool) { init(entity, *pool->get(id.id)...); }, pools);
+    }
 
     if (active) {
-        entities.back().activate();
+        active_entities.reserve(active_entities.size() + count);
+        for (EntityID id : ids) {
+            entities[id].m_active = true;
+            entity_activated(id);
+            ((Types::overrides(HOOK_ENTITY_ACTIVATED)
+                  ? std::get<ComponentPool<Types>*>(pools)->get(id)->entity_activated()
+                  : void()),
+             ...);
+        }
     }
+    return ids;
+}
 
-    return entities.back().entity_id;
+template<typename... Types>
+inline std::vector<ecs::EntityID> ecs::ECS::spawn_batch(ID count, bool active) {
+    return spawn_batch<Types...>(count, active, [](Entity&, Types&...) {});
 }
 
 inline void ecs::ECS::destroy_entity(ecs::EntityID id) {
+    // ignore stale ids of entities which have already been destroyed
+    if (!valid(id))
+        return;
+
     // get the entity at the given id
     auto entity = &entities[id];
 
@@ -224,34 +809,164 @@ inline void ecs::ECS::destroy_entity(ecs::EntityID id) {
     // destroy the components
     entity->remove_all_components();
 
-    // set the entity's id to INVALID_ID and the pointer to nullptr
-    entity->entity_id = EntityID{INVALID_ID};
+    // set the entity's id to INVALID_ID and advance the generation so that existing ids of this
+    // entity become stale, then allow the slot to be reused
+    entity->entity_id = EntityID{INVALID_ID, id.generation + 1};
+    free_entities.push_back(id);
 }
 
 inline void ecs::ECS::destroy_all_entities() {
     for (Entity& entity : entities) {
-        destroy_entity(entity.entity_id);
+        if (entity.valid()) {
+            destroy_entity(entity.entity_id);
+        }
     }
-    entities.clear();
+    // the slots keep their generations so ids from before stay stale. all slots are free now,
+    // listed so that the lowest ones are reused first
+    free_entities.resize(entities.size());
+    std::iota(free_entities.rbegin(), free_entities.rend(), ID {0});
 }
 
 inline void ecs::ECS::destroy_all_systems() {
     for (auto sys : systems) {
-        sys->destroyed();
+        if (sys) {
+            sys->destroyed();
+        }
     }
     systems.clear();
+    schedule_outdated = true;
 }
 
+template<typename K, typename... R>
+inline ecs::Query<K, R...>& ecs::ECS::query() {
+    Hash                        hash = get_type_hash<Query<K, R...>, QueryBase>();
+    std::lock_guard<std::mutex> lock(query_mutex);
+    if (hash >= queries.size()) {
+        queries.resize(hash + 1);
+    }
+
+    auto& ptr = queries[hash];
+    if (!ptr) {
+        auto query = std::make_unique<Query<K, R...>>(this, &entities);
+        for (ID id : *smallest_list<K, R...>()) {
+            query->update(entities[id]);
+        }
+        // the query depends on both the required and the excluded component types
+        Signature dependencies = query->mask | query->excluded;
+        for (Hash component = 0; component < ECS_MAX_COMPONENTS; component++) {
+            if (!dependencies.test(component))
+                continue;
+            if (component >= component_queries.size()) {
+                component_queries.resize(component + 1);
+            }
+            component_queries[component].push_back(query.get());
+        }
+        ptr = std::move(query);
+    }
+    return *static_cast<Query<K, R...>*>(ptr.get());
+}
+
+template<typename K, typename... R>
+inline ecs::Group<K, R...>& ecs::ECS::group() {
+    Hash hash = get_type_hash<Group<K, R...>, GroupBase>();
+    if (hash >= groups.size()) {
+        groups.resize(hash + 1);
+    }
+
+    auto& ptr = groups[hash];
+    if (!ptr) {
+        // each pool can only be arranged by a single group. all types are checked before any of
+        // them is claimed so a rejected group leaves no trace
+        for (Hash component : {K::hash(), R::hash()...}) {
+            if (component < owning_groups.size() && owning_groups[component] != nullptr) {
+                throw std::logic_error("ecs: a component type is already owned by another group");
+            }
+        }
+        auto group =
+            std::make_unique<Group<K, R...>>(&entities, &change_tick, pool<K>(), pool<R>()...);
+        for (Hash component : {K::hash(), R::hash()...}) {
+            if (component >= owning_groups.size()) {
+                owning_groups.resize(component + 1, nullptr);
+            }
+            owning_groups[component] = group.get();
+        }
+        for (ID id : *smallest_list<K, R...>()) {
+            if (entities[id].matches(group->mask)) {
+                group->join(id);
+            }
+        }
+        ptr = std::move(group);
+    }
+    return *static_cast<Group<K, R...>*>(ptr.get());
+}
+
+template<typename T>
+inline ecs::Observer& ecs::ECS::observe_added() {
+    return add_observer(added_observers, T::hash());
+}
+
+template<typename T>
+inline ecs::Observer& ecs::ECS::observe_removed() {
+    return add_observer(removed_observers, T::hash());
+}
+
+template<typename K, typename... R>
+inline ecs::Observer& ecs::ECS::observe_entered() {
+    Query<K, R...>& query = this->query<K, R...>();
+    observers.push_back(std::make_unique<Observer>());
+    query.entered.push_back(observers.back().get());
+    return *observers.back();
+}
+
+inline ecs::Observer& ecs::ECS::add_observer(std::vector<std::vector<Observer*>>& table, Hash hash) {
+    if (hash >= table.size()) {
+        table.resize(hash + 1);
+    }
+    observers.push_back(std::make_unique<Observer>());
+    table[hash].push_back(observers.back().get());
+    return *observers.back();
+}
+
+// the pools already contain the components of inactive entities, so only the queries, groups and
+// observers need to be updated when components are added or removed
 inline void ecs::ECS::component_removed(ecs::Hash hash, EntityID id) {
-    if (entities[id].active()) {
-        remove_from_component_list(id, hash);
+    if (hash < removed_observers.size()) {
+        for (Observer* observer : removed_observers[hash]) {
+            observer->record(id);
+        }
+    }
+    if (hash < owning_groups.size() && owning_groups[hash] && owning_groups[hash]->contains(id.id)) {
+        owning_groups[hash]->leave(id.id);
+    }
+    if (hash < component_queries.size()) {
+        // the component is still part of the signature at this point
+        Signature remaining = entities[id.id].signature;
+        remaining.reset(hash);
+        for (QueryBase* query : component_queries[hash]) {
+            query->update(id, entities[id.id].active() && query->accepts(remaining));
+        }
     }
 }
+
 inline void ecs::ECS::component_added(ecs::Hash hash, EntityID id) {
-    if (entities[id].active()) {
-        add_to_component_list(id, hash);
+    if (hash < added_observers.size()) {
+        for (Observer* observer : added_observers[hash]) {
+            observer->record(id);
+        }
+    }
+    if (hash < owning_groups.size() && owning_groups[hash]) {
+        GroupBase* group = owning_groups[hash];
+        if (entities[id.id].matches(group->mask) && !group->contains(id.id)) {
+            group->join(id.id);
+        }
+    }
+    if (hash < component_queries.size()) {
+        for (QueryBase* query : component_queries[hash]) {
+            query->update(entities[id.id]);
+        }
     }
 }
+
 inline void ecs::ECS::entity_activated(ecs::EntityID entity_id) {
     if (entity_id == INVALID_ID || entity_id >= entities.size())
         return;
@@ -261,7 +976,11 @@ inline void ecs::ECS::entity_activated(ecs::EntityID entity_id) {
         return;
 
     add_to_active_entities(entity_id);
-    add_to_component_list(entity_id);
+    for (auto& query : queries) {
+        if (query) {
+            query->update(entities[entity_id]);
+        }
+    }
 }
 
 inline void ecs::ECS::entity_deactivated(ecs::EntityID entity_id) {
@@ -273,31 +992,11 @@ inline void ecs::ECS::entity_deactivated(ecs::EntityID entity_id) {
         return;
     // remove from active entities
     remove_from_active_entities(entity_id);
-    remove_from_component_list(entity_id);
-}
-inline void ecs::ECS::add_to_component_list(ID id) {
-    auto entity = &entities[id];
-    for (auto& [hash, component] : entity->components) {
-        add_to_component_list(id, hash);
-    }
-}
-inline void ecs::ECS::remove_from_component_list(ID id) {
-    auto entity = &entities[id];
-    for (auto& [hash, irrelevant] : entity->components) {
-        remove_from_component_list(id, hash);
-    }
-}
-inline void ecs::ECS::add_to_component_list(ID id, ecs::Hash hash) {
-    // if the component list does not exist, create it
-    if (component_entity_lists.find(hash) == component_entity_lists.end()) {
-        component_entity_lists[hash] = ComponentEntityList{};
-        component_entity_lists[hash].set(&entities, hash);
+    for (auto& query : queries) {
+        if (query) {
+            query->matches.remove(entity_id);
+        }
     }
-    component_entity_lists.at(hash).push_back(id);
-}
-inline void ecs::ECS::remove_from_component_list(ID id, ecs::Hash hash) {
-    auto entity = &entities[id];
-    component_entity_lists.at(hash).remove_at(entity->components[hash]->component_entity_id);
 }
 inline void ecs::ECS::add_to_active_entities(ID id) {
     active_entities.push_back(id);
@@ -307,9 +1006,142 @@ inline void ecs::ECS::remove_from_active_entities(ID id) {
 }
 
 inline void ecs::ECS::process(double delta) {
-    for (auto sys : systems) {
-        sys->process(this, delta);
+    // systems within a stage do not conflict and may run concurrently. the commands recorded by a
+    // stage are applied before the next one starts
+    std::vector<System::Ptr> running {};
+    for (const auto& stage : schedule().stages) {
+        // hold the systems of the stage, a system may destroy itself or others while it runs.
+        // systems destroyed by an earlier stage are skipped
+        running.clear();
+        for (ID system : stage) {
+            if (systems[system]) {
+                running.push_back(systems[system]);
+            }
+        }
+        if (running.size() == 1) {
+            running[0]->process(this, delta);
+        } else if (!running.empty()) {
+            thread_pool.parallel_for(0, running.size(), 1, [&](ID begin, ID end) {
+                for (ID i = begin; i < end; i++) {
+                    running[i]->process(this, delta);
+                }
+            });
+        }
+        // everything written from now on, including the commands of the stage, counts as changed
+        // for the systems of the stage when they run next
+        for (const System::Ptr& system : running) {
+            system->m_last_run = change_tick;
+        }
+        change_tick++;
+        flush_commands();
     }
+    flush_commands();
+    clear_transient();
+}
+
+template<typename T, typename... Fields>
+template<ecs::ID N>
+inline std::tuple_element_t<N, std::tuple<Fields...>>& ecs::ColumnsOf<T, Fields...>::field() {
+    return column_pool->template column<N>()[this->component_entity_id];
+}
+
+template<typename T, typename... Fields>
+template<ecs::ID N>
+inline const std::tuple_element_t<N, std::tuple<Fields...>>&
+    ecs::ColumnsOf<T, Fields...>::field() const {
+    return column_pool->template column<N>()[this->component_entity_id];
+}
+
+inline ecs::CommandBuffer& ecs::ECS::commands() {
+    // remember the buffer of the calling thread so only the first request needs to lock
+    thread_local const ECS*     cached_ecs    = nullptr;
+    thread_local ID             cached_serial = INVALID_ID;
+    thread_local CommandBuffer* cached_buffer = nullptr;
+    if (cached_ecs == this && cached_serial == serial) {
+        return *cached_buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(command_mutex);
+    auto& buffer = command_buffers[std::this_thread::get_id()];
+    if (!buffer) {
+        buffer = std::make_unique<CommandBuffer>();
+    }
+    cached_ecs    = this;
+    cached_serial = serial;
+    cached_buffer = buffer.get();
+    return *buffer;
+}
+
+inline void ecs::ECS::flush_commands() {
+    // take the commands out of the buffers first so that commands recorded while applying end
+    // up in the next flush
+    std::vector<CommandBuffer::Command> pending;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        for (auto& [thread, buffer] : command_buffers) {
+            std::move(buffer->commands.begin(), buffer->commands.end(), std::back_inserter(pending));
+            buffer->clear();
+        }
+    }
+
+    // group the commands by entity while keeping their order per entity. spawns come last
+    std::stable_sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return a.entity < b.entity;
+    });
+    for (auto& command : pending) {
+        command.apply(*this);
+    }
+}
+
+inline void ecs::CommandBuffer::spawn(bool active) {
+    commands.push_back({INVALID_ID, [active](ECS& ecs) { ecs.spawn(active); }});
+}
+
+template<typename F>
+inline void ecs::CommandBuffer::spawn(bool active, F&& init) {
+    commands.push_back({INVALID_ID, [active, init = std::forward<F>(init)](ECS& ecs) mutable {
+                            init(ecs[ecs.spawn(active)]);
+                        }});
+}
+
+inline void ecs::CommandBuffer::destroy_entity(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) { ecs.destroy_entity(id); }});
+}
+
+template<typename T, typename... Args>
+inline void ecs::CommandBuffer::assign(EntityID id, Args&&... args) {
+    commands.push_back(
+        {id, [id, args = std::make_tuple(std::forward<Args>(args)...)](ECS& ecs) mutable {
+             if (!ecs.valid(id))
+                 return;
+             std::apply([&](auto&... values) { ecs[id].template assign<T>(std::move(values)...); },
+                        args);
+         }});
+}
+
+template<typename T>
+inline void ecs::CommandBuffer::remove_component(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].template remove_component<T>();
+                            }
+                        }});
+}
+
+inline void ecs::CommandBuffer::activate(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].activate();
+                            }
+                        }});
+}
+
+inline void ecs::CommandBuffer::deactivate(EntityID id) {
+    commands.push_back({id, [id](ECS& ecs) {
+                            if (ecs.valid(id)) {
+                                ecs[id].deactivate();
+                            }
+                        }});
 }
 
 
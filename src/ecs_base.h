@@ -7,10 +7,26 @@
 
 #include "types.h"
 #include "ids.h"
+#include "component_pool.h"
+#include "signature.h"
+
+#include <memory>
+#include <vector>
 
 namespace ecs{
 
 struct ECSBase {
+    // one sparse set of components per component type, indexed by the component hash
+    std::vector<std::unique_ptr<ComponentPoolBase>> component_pools {};
+    // for each hook, the component types which override it
+    Signature                                       hooked[HOOK_COUNT] {};
+    // stamped into components when they are assigned or written. advanced after each stage of
+    // process(), so it is always larger than the tick at which any system last ran
+    Tick                                            change_tick = 1;
+
+    virtual ~ECSBase() = default;
+
+    // called before a component is taken out of its pool
     virtual void component_removed(Hash, EntityID) = 0;
     virtual void component_added(Hash, EntityID) = 0;
 
@@ -20,6 +36,29 @@ struct ECSBase {
     virtual void destroy_entity(EntityID) = 0;
     virtual void destroy_system(SystemID) = 0;
     virtual void destroy_listener(EventListenerID) = 0;
+
+    // returns the pool for the given component type, creating it if required
+    template<typename T>
+    ComponentPool<T>* pool() {
+        Hash hash = T::hash();
+        if (hash >= component_pools.size()) {
+            component_pools.resize(hash + 1);
+        }
+        auto& ptr = component_pools[hash];
+        if (!ptr) {
+            ptr = std::make_unique<ComponentPool<T>>();
+            ptr->entities.set(hash);
+            for (unsigned hook = 0; hook < HOOK_COUNT; hook++) {
+                hooked[hook].set(hash, T::overrides(ComponentHook(hook)));
+            }
+        }
+        return static_cast<ComponentPool<T>*>(ptr.get());
+    }
+
+    // returns the pool for the given component hash or nullptr if none exists yet
+    ComponentPoolBase* find_pool(Hash hash) const {
+        return hash < component_pools.size() ? component_pools[hash].get() : nullptr;
+    }
 };
 
 }
@@ -2,31 +2,33 @@
 #define ECS_ECS_ENTITY_H_
 
 #include "component.h"
+#include "component_pool.h"
 #include "ecs_base.h"
 #include "hash.h"
-#include "types.h"
 #include "ids.h"
+#include "signature.h"
+#include "types.h"
 
 #include <memory>
-#include <unordered_map>
+#include <type_traits>
 
 namespace ecs {
 
 /**
  * @brief Represents an entity in the ECS (Entity Component System).
  *
- * The Entity class manages a collection of components and provides methods
- * to add, remove, and access these components. It also supports basic operations
- * like checking for component existence and entity comparison.
+ * The Entity class provides methods to add, remove, and access the components
+ * of an entity. The components themselves live in the pools of the ECS. It also
+ * supports basic operations like checking for component existence and entity comparison.
  */
 struct Entity {
     private:
     // Unique identifier for the entity.
     EntityID entity_id;
-    // Container for the entity's components.
-    std::unordered_map<Hash, ComponentPtr> components{};
     // Pointer to the ECS that owns this entity.
     ECSBase* ecs;
+    // One bit for each component type the entity owns.
+    Signature signature {};
     // Checks if its active or inactive.
     bool m_active = false;
 
@@ -42,11 +44,12 @@ struct Entity {
     // Move constructor
     Entity(Entity&& other) noexcept
         : entity_id(other.entity_id)
-        , components(std::move(other.components))
         , ecs(other.ecs)
+        , signature(other.signature)
         , m_active(other.m_active) {
         other.entity_id.id = INVALID_ID;
         other.ecs = nullptr;
+        other.signature.reset();
         other.m_active = false;
     }
 
@@ -58,15 +61,14 @@ struct Entity {
         if (this == &other)
             return *this;
 
-        remove_all_components();
-
         entity_id = other.entity_id;
-        components = std::move(other.components);
         ecs = other.ecs;
+        signature = other.signature;
         m_active = other.m_active;
 
         other.entity_id.id = INVALID_ID;
         other.ecs = nullptr;
+        other.signature.reset();
         other.m_active = false;
         return *this;
     }
@@ -75,67 +77,97 @@ struct Entity {
         : entity_id{INVALID_ID}
         , ecs(p_ecs) {}
 
-    virtual ~Entity() {
-        remove_all_components();
-    }
+    // the components are owned by the pools of the ecs which releases them when the entity
+    // gets destroyed
+    virtual ~Entity() = default;
 
     template<typename T>
     bool has() const {
-        Hash hash = T::hash();
-        return components.find(hash) != components.end();
+        return signature.test(T::hash());
     }
 
     template<typename T, typename V, typename... Types>
     bool has() const {
-        return has<T>() && has<V, Types...>();
+        static const Signature mask = signature_of<T, V, Types...>();
+        return matches(mask);
     }
 
+    // checks if the entity owns all component types within the given signature
+    bool matches(const Signature& mask) const {
+        return (signature & mask) == mask;
+    }
+
+    // same as above but the entity must not own any of the component types within excluded
+    bool matches(const Signature& mask, const Signature& excluded) const {
+        return (signature & mask) == mask && (signature & excluded).none();
+    }
+
+    // accessing a component mutably marks it as changed, see Changed. get<const T>() yields read-only
+    // access which leaves it untouched
     template<typename T>
     T* get() {
-        Hash hash = get_type_hash<T>();
-        if (components.find(hash) != components.end()) {
-            return static_cast<T*>(components.at(hash).get());
+        using Type = std::remove_const_t<T>;
+        if (!has<Type>()) {
+            return nullptr;
+        }
+        auto pool  = static_cast<ComponentPool<Type>*>(ecs->find_pool(Type::hash()));
+        ID   index = pool->index_of(entity_id.id);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = ecs->change_tick;
         }
-        return nullptr;
+        return &pool->components[index];
     }
 
     template<typename T, typename... Args>
     inline ComponentID assign(Args&&... args) {
-        auto component = std::make_unique<T>(std::forward<Args>(args)...);
-        Hash hashing   = T::hash();
-
-        // assign ecs to the component
-        component->ecs = reinterpret_cast<ECS*>(ecs);
-        // assign id
-        component->component_id = ComponentID{entity_id, hashing};
+        Hash hashing = T::hash();
 
         // If the component already exists, remove it first
         if (has<T>()) {
             remove_component<T>();
         }
 
-        // Add the new component
-        components[hashing] = std::move(component);
+        // Add the new component to the end of its pool
+        ComponentPool<T>* pool      = ecs->pool<T>();
+        T&                component = pool->emplace(entity_id, std::forward<Args>(args)...);
+        // a new component counts as changed
+        pool->ticks.back() = ecs->change_tick;
+
+        // assign ecs to the component
+        component.ecs = reinterpret_cast<ECS*>(ecs);
+        // assign id
+        component.component_id = ComponentID{entity_id, hashing};
+
+        signature.set(hashing);
+
         ecs->component_added(hashing, id());
 
-        // notify all other components that a new component was added
-        for (auto& [hash, comp] : components) {
+        // notify the other components that a new component was added. only components overriding
+        // the hook are visited, so this costs nothing for plain data components
+        const Signature& hooked = ecs->hooked[HOOK_OTHER_COMPONENT_ADDED];
+        for_each_component(hooked, [&](Hash hash, ComponentBase* comp) {
             // dont do it for itself
-            if (hash == hashing)
-                continue;
-
-            // call the other_component_added function
-            comp->other_component_added(hash);
-            components[hashing]->other_component_added(hash);
+            if (hash != hashing) {
+                comp->other_component_added(hashing);
+            }
+        });
+        if constexpr (T::overrides(HOOK_OTHER_COMPONENT_ADDED)) {
+            for_each_component([&](Hash hash, ComponentBase*) {
+                if (hash != hashing) {
+                    get<T>()->other_component_added(hash);
+                }
+            });
         }
 
         // inform the component that it was added to an active entity
-        if (m_active) {
-            component->entity_activated();
+        if constexpr (T::overrides(HOOK_ENTITY_ACTIVATED)) {
+            if (m_active) {
+                get<T>()->entity_activated();
+            }
         }
 
         // return the component id
-        return components[hashing]->component_id;
+        return get<T>()->component_id;
     }
 
     template<typename T>
@@ -143,21 +175,33 @@ struct Entity {
         if (!has<T>())
             return;
 
-        Hash hash = get_type_hash<T>();
-        components[hash]->component_removed();
-        components.erase(hash);
+        Hash hash = T::hash();
+        if constexpr (T::overrides(HOOK_COMPONENT_REMOVED)) {
+            get<T>()->component_removed();
+        }
+        // notify the ecs while the component is still part of its pool
         ecs->component_removed(hash, id());
+        ecs->find_pool(hash)->remove(entity_id.id);
+        signature.reset(hash);
     }
 
     inline void remove_all_components() {
-        for (auto& pair : components) {
-            ecs->component_removed(pair.first, id());
-        }
-        for (auto& pair : components) {
-            pair.second->component_removed();
+        const Signature  owned  = signature;
+        const Signature& hooked = ecs->hooked[HOOK_COMPONENT_REMOVED];
+        // clear each component from the signature as it is reported, so queries and groups never
+        // see the entity with components that were already reported as removed
+        for_each_component([&](Hash hash, ComponentBase* comp) {
+            if (hooked.test(hash)) {
+                comp->component_removed();
+            }
+            signature.reset(hash);
+            ecs->component_removed(hash, id());
+        });
+        for (Hash hash = 0; hash < ecs->component_pools.size(); hash++) {
+            if (owned.test(hash)) {
+                ecs->component_pools[hash]->remove(entity_id.id);
+            }
         }
-
-        components.clear();
     }
 
     inline void destroy() {
@@ -180,9 +224,10 @@ struct Entity {
         if (!m_active) {
             m_active = true;
             ecs->entity_activated(this->entity_id);
-            for (auto& [hash, component] : components) {
-                component->entity_activated();
-            }
+            const Signature& hooked = ecs->hooked[HOOK_ENTITY_ACTIVATED];
+            for_each_component(hooked, [](Hash hash, ComponentBase* comp) {
+                comp->entity_activated();
+            });
         }
     }
 
@@ -190,9 +235,10 @@ struct Entity {
         if (m_active) {
             m_active = false;
             ecs->entity_deactivated(this->entity_id);
-            for (auto& [hash, component] : components) {
-                component->entity_deactivated();
-            }
+            const Signature& hooked = ecs->hooked[HOOK_ENTITY_DEACTIVATED];
+            for_each_component(hooked, [](Hash hash, ComponentBase* comp) {
+                comp->entity_deactivated();
+            });
         }
     }
 
@@ -224,6 +270,27 @@ struct Entity {
         return !(*this < rhs);
     }
 
+    private:
+    // calls the given function with the hash and the component for each component of the entity
+    template<typename F>
+    inline void for_each_component(F&& func) {
+        for_each_component(signature, func);
+    }
+
+    // same as above but restricted to the component types within the given mask
+    template<typename F>
+    inline void for_each_component(const Signature& mask, F&& func) {
+        Signature selected = signature & mask;
+        if (selected.none())
+            return;
+        for (Hash hash = 0; hash < ecs->component_pools.size(); hash++) {
+            if (selected.test(hash)) {
+                func(hash, ecs->component_pools[hash]->get_base(entity_id.id));
+            }
+        }
+    }
+
+    public:
     // Stream output to display hash, id, valid, active all nicely in new rows indented
     friend std::ostream& operator<<(std::ostream& os, const Entity& entity) {
         os << "Entity ID: " << entity.entity_id << std::endl;
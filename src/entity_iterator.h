@@ -2,6 +2,7 @@
 #define ECS_ECS_ITERATOR_H_
 
 #include "entity.h"
+#include "signature.h"
 #include "types.h"
 
 #include <iostream>
@@ -19,8 +20,11 @@ struct EntityIterator {
 
     EntityIterator(std::vector<ID>::iterator id_iter,
                    std::vector<ID>::iterator id_end,
-                   std::vector<Entity>* entity_packs)
-        : m_id_iter(id_iter), m_id_end(id_end), m_entity_packs(entity_packs) {
+                   std::vector<Entity>* entity_packs,
+                   const Signature& mask,
+                   const Signature& excluded)
+        : m_id_iter(id_iter), m_id_end(id_end), m_entity_packs(entity_packs), m_mask(mask),
+          m_excluded(excluded) {
 
         advance_to_next_valid();
     }
@@ -59,11 +63,15 @@ struct EntityIterator {
     std::vector<ID>::iterator m_id_iter;
     std::vector<ID>::iterator m_id_end;
     std::vector<Entity>* m_entity_packs;
+    Signature m_mask;
+    Signature m_excluded;
 
     void advance_to_next_valid() {
 
+        // the component lists also contain inactive entities which are skipped here
         while (   m_id_iter != m_id_end
-               && !(*m_entity_packs)[*m_id_iter].template has<RTypes...>()) {
+               && !(   (*m_entity_packs)[*m_id_iter].active()
+                    && (*m_entity_packs)[*m_id_iter].matches(m_mask, m_excluded))) {
 
             // if id is IVALID_ID, skip
             if (*m_id_iter == INVALID_ID) {
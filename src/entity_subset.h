@@ -7,24 +7,31 @@
 
 
 #include "entity_iterator.h"
+#include "terms.h"
 
 namespace ecs {
 
 template<typename... RTypes>
 struct EntitySubSet {
+    static_assert(unfiltered<RTypes...>, "Changed terms are only supported by views");
+
     std::vector<ID>* ids;
     std::vector<Entity>* entries;
+    // the component types each entity must and must not own, computed once for the query
+    Signature mask;
+    Signature excluded;
 
     EntitySubSet(std::vector<ID>* ids, std::vector<Entity>* entries)
-        : ids(ids), entries(entries) {
+        : ids(ids), entries(entries), mask(required_of<RTypes...>()),
+          excluded(excluded_of<RTypes...>()) {
     }
 
     EntityIterator<RTypes...> begin() {
-        return EntityIterator<RTypes...> {ids->begin(), ids->end(), entries};
+        return EntityIterator<RTypes...> {ids->begin(), ids->end(), entries, mask, excluded};
     }
 
     EntityIterator<RTypes...> end() {
-        return EntityIterator<RTypes...> {ids->end(), ids->end(), entries};
+        return EntityIterator<RTypes...> {ids->end(), ids->end(), entries, mask, excluded};
     }
 };
 }
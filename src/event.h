@@ -21,7 +21,7 @@ struct EventListenerBase {
 
 template<typename Event>
 struct EventListener : public EventListenerBase {
-    const Hash hash = get_type_hash<Event>();
+    const Hash hash = get_type_hash<Event, EventListenerBase>();
 
     virtual void receive(ECS* ecs, const Event& event) = 0;
 };
@@ -0,0 +1,145 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_GROUP_H
+#define ECS_GROUP_H
+
+#include "component_pool.h"
+#include "entity.h"
+#include "ids.h"
+#include "signature.h"
+#include "types.h"
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace ecs {
+
+// type-erased part of an owning group which the ecs keeps up to date
+struct GroupBase {
+    // the owned component types
+    Signature                       mask {};
+    std::vector<ComponentPoolBase*> pools {};
+    // the entities owning all of the types are stored at the first size positions of every pool
+    ID                              size = 0;
+
+    virtual ~GroupBase() = default;
+
+    bool contains(ID entity) const {
+        ID index = pools[0]->index_of(entity);
+        return index != INVALID_ID && index < size;
+    }
+
+    // moves the components of the entity to the end of the group within every pool
+    void join(ID entity) {
+        for (ComponentPoolBase* pool : pools) {
+            pool->swap_at(pool->index_of(entity), size);
+        }
+        size++;
+    }
+
+    // moves the components of the entity right behind the group within every pool
+    void leave(ID entity) {
+        size--;
+        for (ComponentPoolBase* pool : pools) {
+            pool->swap_at(pool->index_of(entity), size);
+        }
+    }
+};
+
+/**
+ * @brief Owning group keeping the pools of the given component types sorted in lockstep.
+ *
+ * Entities owning all of the types are moved to the front of every owned pool in the same order,
+ * so the components at position i of each pool belong to the same entity. Iterating a group is a
+ * parallel linear scan over the pools, which ECS::for_each_chunk over the same types benefits from
+ * as well. Each component type can be owned by a single group only.
+ *
+ * @tparam Types The owned component types.
+ */
+template<typename... Types>
+struct Group : GroupBase {
+    using value_type = std::tuple<EntityID, Types&...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Group::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const Group* group, ID position)
+            : m_group(group), m_position(position) {
+            advance_to_next_valid();
+        }
+
+        // the components are yielded as mutable references and therefore marked as changed
+        reference operator*() const {
+            auto& first = *std::get<0>(m_group->typed_pools);
+            ((std::get<ComponentPool<Types>*>(m_group->typed_pools)->ticks[m_position] =
+                  *m_group->tick),
+             ...);
+            return value_type {(*m_group->entities)[first.entities[m_position]].id(),
+                               std::get<ComponentPool<Types>*>(m_group->typed_pools)
+                                   ->components[m_position]...};
+        }
+
+        iterator& operator++() {
+            ++m_position;
+            advance_to_next_valid();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
+        }
+
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
+        }
+
+        private:
+        const Group* m_group;
+        ID           m_position;
+
+        // skips inactive entities
+        void advance_to_next_valid() {
+            auto& first = *std::get<0>(m_group->typed_pools);
+            while (m_position < m_group->size
+                   && !(*m_group->entities)[first.entities[m_position]].active()) {
+                ++m_position;
+            }
+        }
+    };
+
+    std::vector<Entity>*                 entities;
+    // the current tick of the ecs, see Changed
+    const Tick*                          tick;
+    std::tuple<ComponentPool<Types>*...> typed_pools;
+
+    Group(std::vector<Entity>* entries, const Tick* clock, ComponentPool<Types>*... owned)
+        : entities(entries), tick(clock), typed_pools(owned...) {
+        mask  = signature_of<Types...>();
+        pools = {owned...};
+    }
+
+    iterator begin() const {
+        return iterator {this, 0};
+    }
+
+    iterator end() const {
+        return iterator {this, size};
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_GROUP_H
@@ -5,23 +5,62 @@
 #ifndef ECS_ECS_HASH_H_
 #define ECS_ECS_HASH_H_
 
+#include "signature.h"
 #include "types.h"
 
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
 namespace ecs {
 
+/**
+ * @brief Hands out consecutive hashes for the types of a family.
+ *
+ * Each family (e.g. components or events) counts separately so the hashes of a family stay small
+ * and dense and can be used to index plain arrays.
+ *
+ * @tparam Family The family the hashes are generated for.
+ */
+template<typename Family>
+struct TypeCounter {
+    static Hash next() {
+        static std::atomic<Hash> counter {0};
+        return counter++;
+    }
+};
+
+// component hashes index the signature of an entity, so the limit is checked as soon as a
+// component type asks for its hash, before any signature is touched
+template<>
+struct TypeCounter<ComponentBase> {
+    static Hash next() {
+        static std::atomic<Hash> counter {0};
+        Hash                     hash = counter++;
+        if (hash >= ECS_MAX_COMPONENTS) {
+            throw std::length_error("ecs: more than " + std::to_string(ECS_MAX_COMPONENTS)
+                                    + " component types, define a larger ECS_MAX_COMPONENTS");
+        }
+        return hash;
+    }
+};
+
 /**
  * @brief Generates a hash for the specified type.
  *
- * This function template generates a hash value for a given type using
- * the C++ type_index and typeid mechanisms. This is useful for type identification
- * and comparison within the ECS (Entity Component System) framework.
+ * This function template assigns each type a small integer the first time it is
+ * requested for a given family. The hash is cached in a static so later calls are
+ * a plain load. This is used for type identification and to index the pools and
+ * listener lists within the ECS (Entity Component System) framework.
  *
  * @tparam T The type for which the hash is to be generated.
+ * @tparam Family The family whose counter is used, defaults to a shared family.
  * @return Hash The generated hash value representing the type.
  */
-template<typename T>
+template<typename T, typename Family = void>
 Hash get_type_hash() {
-    return std::type_index(typeid(T));
+    static const Hash hash = TypeCounter<Family>::next();
+    return hash;
 }
 
 }    // namespace ecs_
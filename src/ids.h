@@ -9,8 +9,11 @@
 
 namespace ecs {
 
+// the id of an entity is the slot it occupies within the ecs. slots are reused once an entity is
+// destroyed, so each id also carries the generation of its slot to detect stale handles.
 struct EntityID {
-    ID id = INVALID_ID;
+    ID id         = INVALID_ID;
+    ID generation = 0;
     operator ID() const { return id; }
     operator ID&() { return id; }
 };
@@ -20,8 +23,6 @@ struct ComponentID {
     Hash hash = INVALID_HASH;
     operator ID() const { return id; }
     operator ID&() { return id; }
-    operator Hash() const { return hash; }
-    operator Hash&() { return hash; }
 };
 
 struct SystemID {
@@ -35,8 +36,6 @@ struct EventListenerID {
     Hash hash = INVALID_HASH;
     operator ID() const { return id; }
     operator ID&() { return id; }
-    operator Hash() const { return hash; }
-    operator Hash&() { return hash; }
 };
 
 } // namespace ecs
@@ -11,6 +11,7 @@
 #include "ecs.h"
 #include "entity.h"
 #include "event.h"
+#include "simd.h"
 #include "system.h"
 
 #endif    // ECS_ECS_CORE_H_
@@ -1,5 +1,6 @@
 #include "include.h"
 
+#include <cmath>
 #include <iostream>
 
 struct C1 : public ecs::ComponentOf<C1> {
@@ -92,7 +93,7 @@ struct CollisionListener : public ecs::EventListener<Collision> {
 
             // if it has energy loss, apply it using v2^2 = v1^2 * (1 - loss)
             if(ent.has<EnergyLoss>()) {
-                auto& loss = *ent.get<EnergyLoss>();
+                auto& loss = *ent.get<const EnergyLoss>();
                 comp.vel = std::sqrt(comp.vel * comp.vel * (1 - loss.loss));
             }
         }
@@ -101,6 +102,11 @@ struct CollisionListener : public ecs::EventListener<Collision> {
 };
 
 struct Gravity : public ecs::System{
+    Gravity() {
+        // the collision listener runs within this system as well
+        reads<EnergyLoss>();
+        writes<Ball>();
+    }
     virtual ~Gravity() {};
     void process(ecs::ECS* ecs, double delta) {
         for(auto& ent: ecs->each<Ball>()) {
@@ -118,10 +124,13 @@ struct Gravity : public ecs::System{
 };
 
 struct Display : public ecs::System{
+    Display() {
+        reads<Ball>();
+    }
     virtual ~Display() {};
     void process(ecs::ECS* ecs, double delta) {
         for(auto& ent: ecs->each<Ball>()) {
-            auto& comp = *ent.get<Ball>();
+            auto& comp = *ent.get<const Ball>();
             std::cout << "Ball Position: " << comp.pos << std::endl;
         }
     }
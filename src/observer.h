@@ -0,0 +1,62 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_OBSERVER_H
+#define ECS_OBSERVER_H
+
+#include "ids.h"
+#include "types.h"
+
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Buffers the entities affected by one kind of structural change until they are drained.
+ *
+ * Observers are registered by ECS::observe_added, ECS::observe_removed and ECS::observe_entered.
+ * Instead of calling back into user code for every change, the ecs only appends the id of the
+ * affected entity, and a system handles all of them at once, usually once per frame.
+ */
+struct Observer {
+    // the affected entities in the order of the changes. an entity is recorded once per change, so
+    // it may be listed repeatedly and may have been destroyed by the time the observer is drained
+    std::vector<EntityID> entities {};
+
+    void record(EntityID id) {
+        entities.push_back(id);
+    }
+
+    ID size() const {
+        return entities.size();
+    }
+
+    bool empty() const {
+        return entities.empty();
+    }
+
+    // calls func(id) for each recorded entity and clears the buffer. changes caused by func are
+    // recorded for the next drain
+    template<typename F>
+    void drain(F&& func) {
+        std::vector<EntityID> drained {};
+        drained.swap(entities);
+        for (EntityID id : drained) {
+            func(id);
+        }
+        // keep the storage unless func recorded further changes
+        if (entities.empty()) {
+            drained.clear();
+            entities.swap(drained);
+        }
+    }
+
+    void clear() {
+        entities.clear();
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_OBSERVER_H
@@ -0,0 +1,145 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_QUERY_H
+#define ECS_QUERY_H
+
+#include "ecs_base.h"
+#include "entity.h"
+#include "ids.h"
+#include "observer.h"
+#include "signature.h"
+#include "terms.h"
+#include "types.h"
+#include "vector_indexed.h"
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace ecs {
+
+// type-erased part of a query which the ecs keeps up to date
+struct QueryBase {
+    // the component types an entity must own and those it must not own
+    Signature              mask {};
+    Signature              excluded {};
+    // the active entities matching both
+    IndexedVector          matches {};
+    // observers recording the entities which start matching, see ECS::observe_entered
+    std::vector<Observer*> entered {};
+
+    virtual ~QueryBase() = default;
+
+    // checks if an entity owning the given component types would match
+    bool accepts(const Signature& signature) const {
+        return (signature & mask) == mask && (signature & excluded).none();
+    }
+
+    // adds or removes the entity depending on whether it currently matches
+    void update(const Entity& entity) {
+        update(entity.id(), entity.active() && entity.matches(mask, excluded));
+    }
+
+    void update(EntityID entity, bool matching) {
+        if (matching && !matches.contains(entity.id)) {
+            matches.push_back(entity.id);
+            for (Observer* observer : entered) {
+                observer->record(entity);
+            }
+        } else if (!matching && matches.contains(entity.id)) {
+            matches.remove(entity.id);
+        }
+    }
+};
+
+/**
+ * @brief Persistent query over the active entities owning all given components.
+ *
+ * Queries are registered once by ECS::query and the ecs updates their list of matching entities
+ * whenever components are added or removed and entities are activated or deactivated. Iterating
+ * a query therefore walks its matches without filtering, yielding the same tuples as a View.
+ *
+ * @tparam Terms The component types each entity must own and further terms.
+ */
+template<typename... Terms>
+struct Query : QueryBase {
+    static_assert(unfiltered<Terms...>, "Changed terms are only supported by views");
+
+    using value_type = TermValues<Terms...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Query::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const Query* query, TermPools<Terms...> pools, ID position)
+            : m_query(query), m_pools(pools), m_position(position) {}
+
+        reference operator*() const {
+            ID id = m_query->matches[m_position];
+            return term_values<Terms...>((*m_query->entities)[id].id(),
+                                         m_pools,
+                                         m_query->ecs->change_tick,
+                                         std::index_sequence_for<Terms...> {});
+        }
+
+        iterator& operator++() {
+            ++m_position;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
+        }
+
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
+        }
+
+        private:
+        const Query*        m_query;
+        TermPools<Terms...> m_pools;
+        ID                  m_position;
+    };
+
+    ECSBase*             ecs;
+    std::vector<Entity>* entities;
+
+    Query(ECSBase* owner, std::vector<Entity>* entries)
+        : ecs(owner), entities(entries) {
+        mask     = required_of<Terms...>();
+        excluded = excluded_of<Terms...>();
+    }
+
+    ID size() const {
+        return matches.size();
+    }
+
+    // the pools are looked up once per iteration. if one is missing, there are no matches either
+    iterator begin() const {
+        return iterator {this, pools(), 0};
+    }
+
+    iterator end() const {
+        return iterator {this, pools(), matches.size()};
+    }
+
+    private:
+    TermPools<Terms...> pools() const {
+        return find_term_pools<Terms...>(ecs);
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_QUERY_H
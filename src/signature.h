@@ -0,0 +1,40 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SIGNATURE_H
+#define ECS_SIGNATURE_H
+
+#include "types.h"
+
+#include <bitset>
+
+// maximum amount of distinct component types. can be raised at compile time if required
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+
+namespace ecs {
+
+// set of component types, one bit per component hash
+typedef std::bitset<ECS_MAX_COMPONENTS> Signature;
+
+/**
+ * @brief Builds the signature containing the given component types.
+ *
+ * Queries compute this once so matching an entity against all requested
+ * component types becomes a single AND and compare.
+ *
+ * @tparam Types The component types to set within the signature.
+ * @return Signature The signature with the bits of all given types set.
+ */
+template<typename... Types>
+Signature signature_of() {
+    Signature signature {};
+    (signature.set(Types::hash()), ...);
+    return signature;
+}
+
+}    // namespace ecs
+
+#endif    // ECS_SIGNATURE_H
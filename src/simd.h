@@ -0,0 +1,138 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SIMD_H
+#define ECS_SIMD_H
+
+#include "types.h"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// vectorised kernels for common update patterns on contiguous arrays, e.g. the runs handed out by
+// ECS::for_each_chunk or the columns of columnar components. float and double use sse2 or avx
+// where available, all other types and the remaining elements use plain loops.
+namespace ecs::simd {
+
+namespace detail {
+
+// the registers and operations used for a type. width 1 means no vector registers are used
+template<typename T>
+struct Lanes {
+    static constexpr ID width = 1;
+};
+
+#if defined(__AVX__)
+template<>
+struct Lanes<float> {
+    using Vec                 = __m256;
+    static constexpr ID width = 8;
+
+    static Vec  set(float x) { return _mm256_set1_ps(x); }
+    static Vec  load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+};
+
+template<>
+struct Lanes<double> {
+    using Vec                 = __m256d;
+    static constexpr ID width = 4;
+
+    static Vec  set(double x) { return _mm256_set1_pd(x); }
+    static Vec  load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+template<>
+struct Lanes<float> {
+    using Vec                 = __m128;
+    static constexpr ID width = 4;
+
+    static Vec  set(float x) { return _mm_set1_ps(x); }
+    static Vec  load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+};
+
+template<>
+struct Lanes<double> {
+    using Vec                 = __m128d;
+    static constexpr ID width = 2;
+
+    static Vec  set(double x) { return _mm_set1_pd(x); }
+    static Vec  load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+    static Vec  add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+    static Vec  mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+    static Vec  min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    static Vec  max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+};
+#endif
+
+}    // namespace detail
+
+// y[i] += a * x[i]
+template<typename T>
+inline void axpy(T* y, const T* x, T a, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto va = L::set(a);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(y + i, L::add(L::load(y + i), L::mul(va, L::load(x + i))));
+        }
+    }
+    for (; i < count; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+// x[i] *= a
+template<typename T>
+inline void scale(T* x, T a, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto va = L::set(a);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(x + i, L::mul(va, L::load(x + i)));
+        }
+    }
+    for (; i < count; i++) {
+        x[i] *= a;
+    }
+}
+
+// x[i] = min(max(x[i], low), high)
+template<typename T>
+inline void clamp(T* x, T low, T high, ID count) {
+    using L = detail::Lanes<T>;
+    ID i    = 0;
+    if constexpr (L::width > 1) {
+        auto vl = L::set(low);
+        auto vh = L::set(high);
+        for (; i + L::width <= count; i += L::width) {
+            L::store(x + i, L::min(L::max(L::load(x + i), vl), vh));
+        }
+    }
+    for (; i < count; i++) {
+        x[i] = x[i] < low ? low : (high < x[i] ? high : x[i]);
+    }
+}
+
+}    // namespace ecs::simd
+
+#endif    // ECS_SIMD_H
@@ -6,6 +6,7 @@
 #define ECS_ECS_SYSTEM_H_
 
 #include "ecs_base.h"
+#include "signature.h"
 #include "types.h"
 
 #include <memory>
@@ -17,9 +18,57 @@ struct System {
 
     friend struct ECS;
 
+    // component types the system reads and writes
+    const Signature& read_access() const {
+        return m_reads;
+    }
+    const Signature& write_access() const {
+        return m_writes;
+    }
+    bool declares_access() const {
+        return m_declared;
+    }
+
+    // the tick at which the system last ran or zero if it never did. pass it to ECS::view to only
+    // visit the components changed since then
+    Tick last_run() const {
+        return m_last_run;
+    }
+
+    // two systems conflict if one of them writes what the other one accesses. systems which did
+    // not declare their access may touch anything and therefore conflict with every other system
+    bool conflicts_with(const System& other) const {
+        if (!m_declared || !other.m_declared)
+            return true;
+        return (m_writes & (other.m_reads | other.m_writes)).any()
+               || (other.m_writes & m_reads).any();
+    }
+
     protected:
+    // declare the components accessed within process(), usually from the constructor of the system.
+    // any mutable access marks components as changed, see Changed, and therefore is a write: this
+    // includes non-const view and query terms, Entity::get<T>, groups, for_each_chunk and column.
+    // systems which only declare reads<T> must access T as const T, e.g. view<const T>() or
+    // get<const T>(), since systems reading the same types run concurrently
+    template<typename... Types>
+    void reads() {
+        m_reads |= signature_of<Types...>();
+        m_declared = true;
+    }
+    template<typename... Types>
+    void writes() {
+        m_writes |= signature_of<Types...>();
+        m_declared = true;
+    }
+
     virtual void process(ECS* ecs, double delta) = 0;
     virtual void destroyed() {};
+
+    private:
+    Signature m_reads {};
+    Signature m_writes {};
+    bool      m_declared = false;
+    Tick      m_last_run = 0;
 };
 
 }    // namespace ecs_
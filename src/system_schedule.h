@@ -0,0 +1,74 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_SYSTEM_SCHEDULE_H
+#define ECS_SYSTEM_SCHEDULE_H
+
+#include "ids.h"
+#include "system.h"
+#include "types.h"
+#include "vector_recycling.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Order in which the systems of an ECS are processed.
+ *
+ * A system depends on every system registered before it which it conflicts with, i.e. one of
+ * both writes a component the other one accesses. These dependencies form a DAG which is split
+ * into stages: each system is placed one stage after the last of its dependencies. Systems within
+ * a stage never conflict and run concurrently, the stages run one after another.
+ */
+struct SystemSchedule {
+    // systems which have to finish before a system may start, indexed by the system id
+    std::vector<std::vector<SystemID>> dependencies {};
+    // groups of systems which run concurrently, processed in order
+    std::vector<std::vector<SystemID>> stages {};
+
+    void build(const RecyclingVector<System::Ptr>& systems) {
+        dependencies.assign(systems.size(), {});
+        stages.clear();
+
+        std::vector<ID> stage_of(systems.size(), 0);
+        for (ID id = 0; id < systems.size(); id++) {
+            if (!systems[id])
+                continue;
+
+            ID stage = 0;
+            for (ID prev = 0; prev < id; prev++) {
+                if (systems[prev] && systems[id]->conflicts_with(*systems[prev])) {
+                    dependencies[id].push_back(SystemID {prev});
+                    stage = std::max(stage, stage_of[prev] + 1);
+                }
+            }
+
+            stage_of[id] = stage;
+            if (stage >= stages.size()) {
+                stages.resize(stage + 1);
+            }
+            stages[stage].push_back(SystemID {id});
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const SystemSchedule& schedule) {
+        os << "System Schedule: " << std::endl;
+        os << "-----------------" << std::endl;
+        for (ID stage = 0; stage < schedule.stages.size(); stage++) {
+            os << "Stage " << stage << ":";
+            for (const auto& id : schedule.stages[stage]) {
+                os << " " << id.id;
+            }
+            os << std::endl;
+        }
+        return os;
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_SYSTEM_SCHEDULE_H
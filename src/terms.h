@@ -0,0 +1,242 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_TERMS_H
+#define ECS_TERMS_H
+
+#include "component_pool.h"
+#include "ecs_base.h"
+#include "ids.h"
+#include "signature.h"
+#include "types.h"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ecs {
+
+// query term excluding all entities which own any of the given component types
+template<typename... Types>
+struct Without {};
+
+// query term yielding a pointer to the component, which is nullptr if the entity does not own one
+template<typename T>
+struct Optional {};
+
+// view and query term yielding a reference to the N-th field of the columnar component T, see
+// ColumnsOf. the column is looked up once per iteration, so only the field itself is touched
+template<typename T, ID N>
+struct Field {};
+
+// view term requiring the component to have changed after the tick the view was created for,
+// see ECS::view. it yields nothing, so it is usually combined with T or const T
+template<typename T>
+struct Changed {};
+
+/**
+ * @brief Describes how a term of a query restricts the entities and what it yields for them.
+ *
+ * Plain component types are required and yield a reference to the component. Accessing it this
+ * way marks the component as changed at the current tick, see Changed, and therefore counts as a
+ * write of T for scheduling, see System::writes. Const component types yield a const reference
+ * and leave the component untouched. The same holds for the component types of Optional and
+ * Field. See Without, Optional, Field and Changed for the other terms.
+ */
+template<typename T>
+struct Term {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = true;
+    // terms which look at the components themselves to decide if an entity matches
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<T&> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool->index_of(entity);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {pool->components[index]};
+    }
+};
+
+template<typename... Types>
+struct Term<Without<Types...>> {
+    static constexpr bool required = false;
+    static constexpr bool filtered = false;
+    using Pool                     = std::nullptr_t;
+
+    static Signature required_mask() {
+        return Signature {};
+    }
+    static Signature excluded_mask() {
+        return signature_of<Types...>();
+    }
+    static Pool find(ECSBase*) {
+        return nullptr;
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<> get(Pool, ID, Tick) {
+        return {};
+    }
+};
+
+template<typename T>
+struct Term<Optional<T>> {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = false;
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return Signature {};
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<T*> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool != nullptr ? pool->index_of(entity) : INVALID_ID;
+        if (index == INVALID_ID)
+            return {nullptr};
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {&pool->components[index]};
+    }
+};
+
+template<typename T, ID N>
+struct Term<Field<T, N>> {
+    using Type    = std::remove_const_t<T>;
+    using Element = std::tuple_element_t<N, typename Type::column_types>;
+    using Value   = std::conditional_t<std::is_const_v<T>, const Element&, Element&>;
+
+    static constexpr bool required = true;
+    static constexpr bool filtered = false;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool, ID, Tick) {
+        return true;
+    }
+    static std::tuple<Value> get(Pool pool, ID entity, Tick tick) {
+        ID index = pool->index_of(entity);
+        if constexpr (!std::is_const_v<T>) {
+            pool->ticks[index] = tick;
+        }
+        return {pool->template column<N>()[index]};
+    }
+};
+
+template<typename T>
+struct Term<Changed<T>> {
+    using Type = std::remove_const_t<T>;
+
+    static constexpr bool required = true;
+    static constexpr bool filtered = true;
+    using Pool                     = ComponentPool<Type>*;
+
+    static Signature required_mask() {
+        return signature_of<Type>();
+    }
+    static Signature excluded_mask() {
+        return Signature {};
+    }
+    static Pool find(ECSBase* ecs) {
+        return static_cast<Pool>(ecs->find_pool(Type::hash()));
+    }
+    static bool accepts(Pool pool, ID entity, Tick since) {
+        return pool->ticks[pool->index_of(entity)] > since;
+    }
+    static std::tuple<> get(Pool, ID, Tick) {
+        return {};
+    }
+};
+
+// true if none of the given terms needs to look at the components to decide if an entity matches
+template<typename... Terms>
+constexpr bool unfiltered = !(Term<Terms>::filtered || ...);
+
+// the component types an entity must own to match the given terms
+template<typename... Terms>
+Signature required_of() {
+    Signature signature {};
+    ((signature |= Term<Terms>::required_mask()), ...);
+    return signature;
+}
+
+// the component types an entity must not own to match the given terms
+template<typename... Terms>
+Signature excluded_of() {
+    Signature signature {};
+    ((signature |= Term<Terms>::excluded_mask()), ...);
+    return signature;
+}
+
+// the pools accessed by the given terms
+template<typename... Terms>
+using TermPools = std::tuple<typename Term<Terms>::Pool...>;
+
+template<typename... Terms>
+TermPools<Terms...> find_term_pools(ECSBase* ecs) {
+    return TermPools<Terms...> {Term<Terms>::find(ecs)...};
+}
+
+// checks the filtering terms for an entity which owns all required component types
+template<typename... Terms, std::size_t... I>
+bool term_accepts(ID id, const TermPools<Terms...>& pools, Tick since, std::index_sequence<I...>) {
+    return (Term<Terms>::accepts(std::get<I>(pools), id, since) && ...);
+}
+
+// the tuple of the entity id followed by the values yielded by each term. components accessed
+// mutably are stamped with the given tick
+template<typename... Terms, std::size_t... I>
+auto term_values(EntityID                   id,
+                 const TermPools<Terms...>& pools,
+                 Tick                       tick,
+                 std::index_sequence<I...>) {
+    return std::tuple_cat(std::tuple<EntityID> {id},
+                          Term<Terms>::get(std::get<I>(pools), id, tick)...);
+}
+
+template<typename... Terms>
+using TermValues = decltype(term_values<Terms...>(EntityID {},
+                                                  std::declval<const TermPools<Terms...>&>(),
+                                                  Tick {},
+                                                  std::index_sequence_for<Terms...> {}));
+
+}    // namespace ecs
+
+#endif    // ECS_TERMS_H
@@ -0,0 +1,344 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_THREAD_POOL_H
+#define ECS_THREAD_POOL_H
+
+#include "types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecs {
+
+// statistics of a thread pool, either of a single thread or accumulated over all of them
+struct ThreadPoolStats {
+    // jobs executed
+    ID     jobs_run  = 0;
+    // jobs taken from the queue of another thread
+    ID     steals    = 0;
+    // seconds spent waiting for jobs
+    double idle_time = 0;
+};
+
+/**
+ * @brief Work-stealing job system.
+ *
+ * Each worker owns a deque of jobs. Jobs submitted by a worker go to the back of its own deque
+ * and are taken from there again, so related work stays on the same thread. Workers running out
+ * of jobs steal the oldest job from the front of another deque. Jobs submitted by threads outside
+ * of the pool go to a shared deque which is treated like the one of an additional worker.
+ *
+ * The workers are only started once the first job is submitted, so an ECS which never runs
+ * anything in parallel never spawns a thread. Threads waiting for jobs to finish help processing
+ * them instead of blocking, which allows jobs to submit and wait for further jobs.
+ */
+struct ThreadPool {
+    using Job = std::function<void()>;
+
+    // thread_count includes the calling thread. zero picks the amount of hardware threads
+    explicit ThreadPool(ID thread_count = 0) {
+        set_thread_count(thread_count);
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        stop();
+    }
+
+    // amount of threads taking part in parallel work, including the calling one
+    ID size() const {
+        return thread_count_;
+    }
+
+    // changes the amount of threads. finishes all queued jobs first and must not be called
+    // from within a job
+    void set_thread_count(ID thread_count) {
+        stop();
+        thread_count_ = thread_count > 0 ? thread_count
+                                         : std::max<ID>(1, std::thread::hardware_concurrency());
+        slots_.clear();
+        for (ID i = 0; i < thread_count_; i++) {
+            slots_.push_back(std::make_unique<Slot>());
+        }
+    }
+
+    // queues a job. runs it right away if there are no workers
+    void submit(Job job) {
+        if (thread_count_ <= 1) {
+            job();
+            return;
+        }
+        start();
+
+        Slot& slot = *slots_[current_slot()];
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            slot.jobs.push_back(std::move(job));
+            pending_++;
+        }
+        {
+            // synchronise with workers about to fall asleep so the notification is not lost
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_condition_.notify_one();
+    }
+
+    // runs one queued job on the calling thread, preferring its own queue over stealing.
+    // returns false if there was no job to run
+    bool run_pending() {
+        if (pending_ == 0)
+            return false;
+
+        ID  self = current_slot();
+        Job job;
+        if (pop_back(self, job)) {
+            slots_[self]->jobs_run++;
+            job();
+            return true;
+        }
+        for (ID offset = 1; offset < slots_.size(); offset++) {
+            ID victim = (self + offset) % slots_.size();
+            if (steal_front(victim, job)) {
+                slots_[self]->steals++;
+                slots_[self]->jobs_run++;
+                job();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Fork/join helper to wait for a set of jobs.
+     *
+     * Jobs are forked with run() and joined with wait(), which processes pending jobs of the
+     * pool until all jobs of the group finished. The destructor waits as well.
+     */
+    struct JobGroup {
+        explicit JobGroup(ThreadPool& pool)
+            : pool_(pool) {}
+
+        JobGroup(const JobGroup&)            = delete;
+        JobGroup& operator=(const JobGroup&) = delete;
+
+        ~JobGroup() {
+            wait();
+        }
+
+        void run(Job job) {
+            remaining_++;
+            pool_.submit([this, job = std::move(job)] {
+                job();
+                remaining_--;
+            });
+        }
+
+        void wait() {
+            while (remaining_ > 0) {
+                if (!pool_.run_pending()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        private:
+        ThreadPool&     pool_;
+        std::atomic<ID> remaining_ {0};
+    };
+
+    // runs all given functions in parallel and returns once all of them finished
+    template<typename... F>
+    void invoke(F&&... funcs) {
+        JobGroup group {*this};
+        (group.run(std::forward<F>(funcs)), ...);
+        group.wait();
+    }
+
+    /**
+     * @brief Splits the range [begin, end) into chunks and processes them in parallel.
+     *
+     * The calling thread processes the first chunk itself and helps with the remaining ones
+     * until all of them are done.
+     *
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param grain_size Amount of indices per chunk. Zero picks a few chunks per thread.
+     * @param func Called as func(chunk_begin, chunk_end) for each chunk.
+     */
+    template<typename F>
+    void parallel_for(ID begin, ID end, ID grain_size, F&& func) {
+        if (begin >= end)
+            return;
+
+        ID count = end - begin;
+        if (grain_size == 0) {
+            grain_size = std::max<ID>(1, count / (thread_count_ * 4));
+        }
+
+        ID chunks = (count + grain_size - 1) / grain_size;
+        if (chunks == 1 || thread_count_ <= 1) {
+            func(begin, end);
+            return;
+        }
+
+        JobGroup group {*this};
+        for (ID chunk = 1; chunk < chunks; chunk++) {
+            ID chunk_begin = begin + chunk * grain_size;
+            ID chunk_end   = std::min(end, chunk_begin + grain_size);
+            group.run([&func, chunk_begin, chunk_end] { func(chunk_begin, chunk_end); });
+        }
+
+        func(begin, begin + grain_size);
+        group.wait();
+    }
+
+    // statistics of a single thread. thread 0 covers all threads outside of the pool
+    ThreadPoolStats stats(ID thread) const {
+        const Slot& slot = *slots_[thread];
+        return ThreadPoolStats {slot.jobs_run,
+                               slot.steals,
+                               static_cast<double>(slot.idle_nanoseconds.load()) * 1e-9};
+    }
+
+    // statistics accumulated over all threads
+    ThreadPoolStats stats() const {
+        ThreadPoolStats total {};
+        for (ID thread = 0; thread < slots_.size(); thread++) {
+            ThreadPoolStats single = stats(thread);
+            total.jobs_run += single.jobs_run;
+            total.steals += single.steals;
+            total.idle_time += single.idle_time;
+        }
+        return total;
+    }
+
+    void reset_stats() {
+        for (auto& slot : slots_) {
+            slot->jobs_run         = 0;
+            slot->steals           = 0;
+            slot->idle_nanoseconds = 0;
+        }
+    }
+
+    private:
+    // queue and statistics of one thread. slot 0 is shared by all threads outside of the pool
+    struct Slot {
+        std::mutex                mutex {};
+        std::deque<Job>           jobs {};
+        std::atomic<ID>           jobs_run {0};
+        std::atomic<ID>           steals {0};
+        std::atomic<std::int64_t> idle_nanoseconds {0};
+    };
+
+    ID                                 thread_count_ = 1;
+    std::vector<std::unique_ptr<Slot>> slots_ {};
+    std::vector<std::thread>           workers_ {};
+    std::atomic<ID>                    pending_ {0};
+    std::atomic<bool>                  started_ {false};
+    std::mutex                         start_mutex_ {};
+    std::mutex                         sleep_mutex_ {};
+    std::condition_variable            sleep_condition_ {};
+    bool                               stopping_ = false;
+
+    // slot of the calling thread within this pool
+    ID current_slot() const {
+        return current_pool() == this ? current_index() : 0;
+    }
+
+    static const ThreadPool*& current_pool() {
+        thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static ID& current_index() {
+        thread_local ID index = 0;
+        return index;
+    }
+
+    bool pop_back(ID index, Job& job) {
+        Slot&                       slot = *slots_[index];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.jobs.empty())
+            return false;
+        job = std::move(slot.jobs.back());
+        slot.jobs.pop_back();
+        pending_--;
+        return true;
+    }
+
+    bool steal_front(ID index, Job& job) {
+        Slot&                       slot = *slots_[index];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.jobs.empty())
+            return false;
+        job = std::move(slot.jobs.front());
+        slot.jobs.pop_front();
+        pending_--;
+        return true;
+    }
+
+    // the calling thread takes part in the work as well, so one worker less is required
+    void start() {
+        if (started_)
+            return;
+        std::lock_guard<std::mutex> lock(start_mutex_);
+        if (started_)
+            return;
+        stopping_ = false;
+        for (ID index = 1; index < thread_count_; index++) {
+            workers_.emplace_back([this, index] { work(index); });
+        }
+        started_ = true;
+    }
+
+    // lets the workers finish all queued jobs and joins them
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_condition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+        started_ = false;
+    }
+
+    void work(ID index) {
+        current_pool()  = this;
+        current_index() = index;
+
+        while (true) {
+            if (run_pending())
+                continue;
+
+            auto idle_start = std::chrono::steady_clock::now();
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                sleep_condition_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+                if (stopping_ && pending_ == 0)
+                    return;
+            }
+            auto idle_end = std::chrono::steady_clock::now();
+            slots_[index]->idle_nanoseconds +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(idle_end - idle_start).count();
+        }
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_THREAD_POOL_H
@@ -5,8 +5,8 @@
 #ifndef ECS_ECS_TYPES_H_
 #define ECS_ECS_TYPES_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <typeindex>
 
 namespace ecs {
 
@@ -15,7 +15,12 @@ struct Entity;
 struct ECSBase;
 struct ECS;
 
+struct ComponentBase;
 struct ComponentEntityList;
+struct ComponentPoolBase;
+
+template<typename T>
+struct ComponentPool;
 
 struct System;
 
@@ -25,11 +30,40 @@ struct EntityIterator;
 template<typename... RTypes>
 struct EntitySubSet;
 
-typedef std::size_t     ID;
-typedef std::type_index Hash;
+template<typename... Types>
+struct View;
+
+struct QueryBase;
+template<typename... Types>
+struct Query;
+
+struct GroupBase;
+template<typename... Types>
+struct Group;
+
+typedef std::size_t ID;
+typedef std::size_t Hash;
+// counts the stages run by the ecs, used to tell which components changed since a system last ran
+typedef std::uint64_t Tick;
 
 #define INVALID_ID   ID(-1)
-#define INVALID_HASH Hash(typeid(void))
+#define INVALID_HASH Hash(-1)
+
+// how pools are sorted. insertion sort is linear for data which is already nearly sorted, e.g.
+// when sorting by a key which changes little from frame to frame
+enum SortMode : unsigned {
+    SORT_FULL,
+    SORT_INSERTION
+};
+
+// the lifecycle hooks of a component which are dispatched by the ecs
+enum ComponentHook : unsigned {
+    HOOK_COMPONENT_REMOVED,
+    HOOK_ENTITY_ACTIVATED,
+    HOOK_ENTITY_DEACTIVATED,
+    HOOK_OTHER_COMPONENT_ADDED,
+    HOOK_COUNT
+};
 
 
 }    // namespace ecs_
@@ -21,43 +21,24 @@ struct CompactVector {
 
     void push_back(const T &element) {
         elements.push_back(element);
+        added(elements.size() - 1);
     }
     void remove(const T &element) {
-        // if the element is at the end, we can simply pop it
-        if (element == elements.back()) {
-            elements.pop_back();
-            removed(element);
-            return;
-        }
-
         // check position of the element
-        auto it = std::find(elements.begin(), elements.end(), element);
+        ID element_id = index_of(element);
 
         // if it doesnt exist, exit here
-        if (it == elements.end()) {
+        if (element_id == INVALID_ID) {
             return;
         }
 
-        // otherwise we need to find the element and move the last element to its position
-        if (it != elements.end()) {
-            // get the id of the last element and the element to be removed
-            auto last_id = elements.size() - 1;
-            auto element_id = static_cast<ID>(std::distance(elements.begin(), it));
-
-            removed(element_id);
-
-            // move
-            elements[element_id] = elements.back();
-            elements.pop_back();
-
-            moved(last_id, element_id);
-        }
+        remove_at(element_id);
     }
     void remove_at(ID id) {
         // if the element is at the end, we can simply pop it
         if (id == elements.size() - 1) {
-            elements.pop_back();
             removed(id);
+            elements.pop_back();
             return;
         }
 
@@ -88,6 +69,15 @@ struct CompactVector {
 
     ID size() const { return elements.size(); }
     void clear() { elements.clear(); }
+    void reserve(ID capacity) { elements.reserve(capacity); }
+
+    // position of the given element or INVALID_ID if it is not contained. searches linearly unless
+    // a derived container keeps track of the positions
+    virtual ID index_of(const T &element) const {
+        auto it = std::find(elements.begin(), elements.end(), element);
+        return it != elements.end() ? static_cast<ID>(std::distance(elements.begin(), it))
+                                    : INVALID_ID;
+    }
 
     protected:
 
@@ -0,0 +1,60 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_VECTOR_INDEXED_H
+#define ECS_VECTOR_INDEXED_H
+
+#include "types.h"
+#include "vector_compact.h"
+
+#include <utility>
+#include <vector>
+
+// a compact vector of ids which additionally tracks the position of each id. this turns it into a
+// sparse set: lookups, insertions and removals by value are constant time while the ids remain
+// packed for iteration.
+namespace ecs {
+
+struct IndexedVector : CompactVector<ID> {
+    // position of each id within the vector, indexed by the id itself
+    std::vector<ID> indices {};
+
+    bool contains(ID id) const {
+        return id < indices.size() && indices[id] != INVALID_ID;
+    }
+
+    ID index_of(const ID& id) const override {
+        return contains(id) ? indices[id] : INVALID_ID;
+    }
+
+    void clear() {
+        CompactVector<ID>::clear();
+        indices.clear();
+    }
+
+    // exchanges the ids at the given positions
+    void swap_at(ID a, ID b) {
+        std::swap(elements[a], elements[b]);
+        indices[elements[a]] = a;
+        indices[elements[b]] = b;
+    }
+
+    protected:
+    void moved(ID from, ID to) override {
+        indices[elements[to]] = to;
+    }
+    void removed(ID id) override {
+        indices[elements[id]] = INVALID_ID;
+    }
+    void added(ID id) override {
+        if (elements[id] >= indices.size()) {
+            indices.resize(elements[id] + 1, INVALID_ID);
+        }
+        indices[elements[id]] = id;
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_VECTOR_INDEXED_H
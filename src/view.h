@@ -0,0 +1,117 @@
+//
+// Created by Finn Eggers on 16.10.26.
+//
+
+#ifndef ECS_VIEW_H
+#define ECS_VIEW_H
+
+#include "ecs_base.h"
+#include "entity.h"
+#include "ids.h"
+#include "signature.h"
+#include "terms.h"
+#include "types.h"
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief Query over the active entities owning all given components, yielding the components.
+ *
+ * Iterating a view yields tuples of the entity id and references to its components, which can be
+ * unpacked using structured bindings. The components are taken from the pools directly, so unlike
+ * Entity::get no further lookups are required. Without, Optional and Changed terms may be used
+ * as well. Components yielded as mutable references are stamped with the tick of the view.
+ *
+ * @tparam Terms The component types each entity must own and further terms.
+ */
+template<typename... Terms>
+struct View {
+    using value_type = TermValues<Terms...>;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = View::value_type;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(const View* view, ID position)
+            : m_view(view), m_position(position) {
+            advance_to_next_valid();
+        }
+
+        reference operator*() const {
+            ID id = (*m_view->ids)[m_position];
+            return term_values<Terms...>((*m_view->entities)[id].id(),
+                                         m_view->pools,
+                                         m_view->tick,
+                                         std::index_sequence_for<Terms...> {});
+        }
+
+        iterator& operator++() {
+            ++m_position;
+            advance_to_next_valid();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const {
+            return m_position == rhs.m_position;
+        }
+
+        bool operator!=(const iterator& rhs) const {
+            return m_position != rhs.m_position;
+        }
+
+        private:
+        const View* m_view;
+        ID          m_position;
+
+        // skips inactive entities and those not matching the terms
+        void advance_to_next_valid() {
+            while (m_position < m_view->ids->size()) {
+                ID            id     = (*m_view->ids)[m_position];
+                const Entity& entity = (*m_view->entities)[id];
+                if (entity.active() && entity.matches(m_view->mask, m_view->excluded)
+                    && (unfiltered<Terms...>
+                        || term_accepts<Terms...>(id,
+                                                  m_view->pools,
+                                                  m_view->since,
+                                                  std::index_sequence_for<Terms...> {})))
+                    return;
+                ++m_position;
+            }
+        }
+    };
+
+    // candidate entities, usually those of the smallest pool among the required types
+    std::vector<ID>*     ids;
+    std::vector<Entity>* entities;
+    TermPools<Terms...>  pools;
+    // the tick stamped into mutably accessed components and the one Changed terms compare to
+    Tick                 tick;
+    Tick                 since;
+    Signature            mask     = required_of<Terms...>();
+    Signature            excluded = excluded_of<Terms...>();
+
+    iterator begin() const {
+        return iterator {this, 0};
+    }
+
+    iterator end() const {
+        return iterator {this, ids->size()};
+    }
+};
+
+}    // namespace ecs
+
+#endif    // ECS_VIEW_H